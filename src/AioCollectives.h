@@ -0,0 +1,109 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2020 Paradigm4 Inc.
+* All Rights Reserved.
+*
+* accelerated_io_tools is a plugin for SciDB, an Open Source Array DBMS maintained
+* by Paradigm4. See http://www.paradigm4.com/
+*
+* accelerated_io_tools is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* accelerated_io_tools is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with accelerated_io_tools.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+#ifndef SRC_AIOCOLLECTIVES_H_
+#define SRC_AIOCOLLECTIVES_H_
+
+#include <query/Query.h>
+#include <network/Network.h>
+#include <system/Exceptions.h>
+
+#include <string.h>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace scidb
+{
+
+/**
+ * Combine values element by element across all instances of the query with
+ * op, leaving every instance with the same combined vector.
+ *
+ * The values are reduced to instance 0 along a binomial tree and the result
+ * is broadcast back down the same tree, so each instance exchanges at most
+ * 2*log2(N) messages instead of the 2*(N-1) of an all-to-all. Every
+ * instance must call this at the same point with vectors of the same size.
+ *
+ * @param values This instance's values on entry, the combined ones on return.
+ * @param op A commutative, associative binary function on T.
+ * @param query The query.
+ */
+template<typename T, typename Op>
+void allReduce(std::vector<T>& values, Op op, std::shared_ptr<Query>& query)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "allReduce sends values as raw bytes");
+    size_t const numInstances = query->getInstancesCount();
+    InstanceID const myId = query->getInstanceID();
+    size_t const size = values.size() * sizeof(T);
+    if (numInstances == 1)
+    {
+        return;
+    }
+    // Reduce: at each level, an instance with the level's bit set hands its
+    // partial result to the partner without it, and drops out.
+    size_t mask = 1;
+    for (; mask < numInstances; mask <<= 1)
+    {
+        if (myId & mask)
+        {
+            std::shared_ptr<SharedBuffer> buf(new MemoryBuffer(SCIDB_CODE_LOC, values.data(), size));
+            BufSend(myId - mask, buf, query);
+            break;
+        }
+        if (myId + mask < numInstances)
+        {
+            std::shared_ptr<SharedBuffer> buf = BufReceive(myId + mask, query);
+            if (buf->getSize() != size)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "allReduce received a message of the wrong size";
+            }
+            T const* other = static_cast<T const*>(buf->getConstData());
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                values[i] = op(values[i], other[i]);
+            }
+        }
+    }
+    // Broadcast: receive the result from the partner sent to above, then pass
+    // it on to the partners received from, largest subtree first.
+    if (myId != 0)
+    {
+        std::shared_ptr<SharedBuffer> buf = BufReceive(myId - mask, query);
+        memcpy(values.data(), buf->getConstData(), size);
+    }
+    for (mask >>= 1; mask > 0; mask >>= 1)
+    {
+        if (myId + mask < numInstances)
+        {
+            std::shared_ptr<SharedBuffer> buf(new MemoryBuffer(SCIDB_CODE_LOC, values.data(), size));
+            BufSend(myId + mask, buf, query);
+        }
+    }
+}
+
+}
+
+#endif /* SRC_AIOCOLLECTIVES_H_ */
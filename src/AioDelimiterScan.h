@@ -0,0 +1,223 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2020 Paradigm4 Inc.
+* All Rights Reserved.
+*
+* accelerated_io_tools is a plugin for SciDB, an Open Source Array DBMS maintained
+* by Paradigm4. See http://www.paradigm4.com/
+*
+* accelerated_io_tools is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* accelerated_io_tools is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with accelerated_io_tools.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+#ifndef SRC_AIODELIMITERSCAN_H_
+#define SRC_AIODELIMITERSCAN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace scidb
+{
+
+/**
+ * Finds the positions of two delimiter characters in a buffer, 64 bytes at
+ * a time: each window is turned into a bitmask with one bit per byte that
+ * matches either delimiter, and successive delimiters are read off the
+ * mask with a count of trailing zeros. Short fields thus cost a bit
+ * operation each instead of a compare per byte.
+ *
+ * Given a quote character, delimiters between quotes are not reported.
+ * The quotes of a window are masked the same way, and a prefix XOR of that
+ * mask marks the bytes inside quotes; the state carries over from one
+ * window to the next. A doubled quote inside a quoted field closes and
+ * reopens it, so it needs no special case. The scan must start outside
+ * quotes.
+ *
+ * The mask kernel is picked once per process: AVX2 where the CPU has it,
+ * SSE2 on any other x86-64, and a plain loop elsewhere.
+ */
+class DelimiterScanner
+{
+public:
+    static size_t const WINDOW = 64;
+
+    /**
+     * @param begin The first byte to scan.
+     * @param end One past the last byte to scan.
+     * @param delimA, delimB The delimiters; they may be the same character.
+     * @param quote The quote character, or 0 for none.
+     */
+    DelimiterScanner(char const* begin, char const* end, char delimA, char delimB, char quote = 0):
+        _window(begin),
+        _end(end),
+        _delimA(delimA),
+        _delimB(delimB),
+        _quote(quote),
+        _inQuotes(0),
+        _maskWindow(maskKernel())
+    {
+        loadWindow();
+    }
+
+    /**
+     * @return the next delimiter after the one returned last time (or at or
+     *    after begin, on the first call); end when there are no more.
+     */
+    char const* next()
+    {
+        while (_mask == 0)
+        {
+            if (_end - _window <= (ptrdiff_t) WINDOW)
+            {
+                return _end;
+            }
+            _window += WINDOW;
+            loadWindow();
+        }
+        char const* found = _window + __builtin_ctzll(_mask);
+        _mask &= _mask - 1;
+        return found;
+    }
+
+private:
+    typedef uint64_t (*MaskKernel)(char const* window, char delimA, char delimB);
+
+    char const*      _window;   // start of the window _mask describes
+    char const*      _end;
+    char const       _delimA;
+    char const       _delimB;
+    char const       _quote;
+    uint64_t         _inQuotes; // all ones if the window starts inside quotes
+    MaskKernel const _maskWindow;
+    uint64_t         _mask;     // the window's delimiters not yet returned
+
+    void loadWindow()
+    {
+        ptrdiff_t const left = _end - _window;
+        uint64_t quotes = 0;
+        if (left >= (ptrdiff_t) WINDOW)
+        {
+            _mask = _maskWindow(_window, _delimA, _delimB);
+            if (_quote)
+            {
+                quotes = _maskWindow(_window, _quote, _quote);
+            }
+        }
+        else
+        {
+            // The tail is not read past _end, which may be the end of a mapping.
+            _mask = scalarMask(_window, left > 0 ? left : 0, _delimA, _delimB);
+            if (_quote)
+            {
+                quotes = scalarMask(_window, left > 0 ? left : 0, _quote, _quote);
+            }
+        }
+        if (_quote)
+        {
+            uint64_t const inside = prefixXor(quotes) ^ _inQuotes;
+            _mask &= ~inside;
+            _inQuotes = uint64_t(0) - (inside >> 63);
+        }
+    }
+
+    // Bit i of the result is the XOR of bits 0 to i of x.
+    static uint64_t prefixXor(uint64_t x)
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    static uint64_t scalarMask(char const* window, size_t size, char delimA, char delimB)
+    {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (window[i] == delimA || window[i] == delimB)
+            {
+                mask |= uint64_t(1) << i;
+            }
+        }
+        return mask;
+    }
+
+    static uint64_t scalarWindow(char const* window, char delimA, char delimB)
+    {
+        return scalarMask(window, WINDOW, delimA, delimB);
+    }
+
+#if defined(__x86_64__)
+    static uint64_t sse2Window(char const* window, char delimA, char delimB)
+    {
+        __m128i const a = _mm_set1_epi8(delimA);
+        __m128i const b = _mm_set1_epi8(delimB);
+        uint64_t mask = 0;
+        for (size_t i = 0; i < WINDOW; i += 16)
+        {
+            __m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(window + i));
+            __m128i const hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, a), _mm_cmpeq_epi8(bytes, b));
+            mask |= uint64_t((uint32_t) _mm_movemask_epi8(hits)) << i;
+        }
+        return mask;
+    }
+
+    __attribute__((target("avx2")))
+    static uint64_t avx2Window(char const* window, char delimA, char delimB)
+    {
+        __m256i const a = _mm256_set1_epi8(delimA);
+        __m256i const b = _mm256_set1_epi8(delimB);
+        __m256i const low = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(window));
+        __m256i const high = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(window + 32));
+        uint32_t const lowMask = _mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(low, a), _mm256_cmpeq_epi8(low, b)));
+        uint32_t const highMask = _mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(high, a), _mm256_cmpeq_epi8(high, b)));
+        return (uint64_t(highMask) << 32) | lowMask;
+    }
+#endif
+
+    static MaskKernel maskKernel()
+    {
+        static MaskKernel const kernel = pickKernel();
+        return kernel;
+    }
+
+    static MaskKernel pickKernel()
+    {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return &avx2Window;
+        }
+        return &sse2Window;
+#else
+        return &scalarWindow;
+#endif
+    }
+};
+
+}
+
+#endif /* SRC_AIODELIMITERSCAN_H_ */
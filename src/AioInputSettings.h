@@ -24,6 +24,7 @@
 */
 
 #include <algorithm>
+#include <limits>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
@@ -58,6 +59,25 @@ static const char* const KW_NUM_ATTR     = "num_attributes";
 static const char* const KW_CHUNK_SZ     = "chunk_size";
 static const char* const KW_SPLIT_ON_DIM = "split_on_dimension";
 static const char* const KW_SKIP         = "skip";
+static const char* const KW_MMAP         = "mmap";
+static const char* const KW_PARALLEL_READ = "parallel_read";
+static const char* const KW_DIRECT_IO    = "direct_io";
+static const char* const KW_HEADER_PREFIX = "header_prefix";
+static const char* const KW_READ_AHEAD   = "read_ahead";
+static const char* const KW_LINE_ALIGNED = "line_aligned";
+static const char* const KW_STREAM_WINDOW = "stream_window";
+static const char* const KW_PARSE_THREADS = "parse_threads";
+static const char* const KW_TYPES        = "types";
+static const char* const KW_TARGET       = "target";
+static const char* const KW_MAPPING      = "mapping";
+static const char* const KW_FORMAT       = "format";
+static const char* const KW_COLUMNS      = "columns";
+static const char* const KW_WHERE        = "where";
+static const char* const KW_SAMPLE       = "sample";
+static const char* const KW_MAX_BYTES    = "max_bytes";
+static const char* const KW_WRITE_INDEX  = "write_index";
+static const char* const KW_USE_INDEX    = "use_index";
+static const char* const KW_RESUME       = "resume";
 
 typedef std::shared_ptr<OperatorParamLogicalExpression> ParamType_t ;
 
@@ -65,6 +85,41 @@ class AioInputSettings
 {
 public:
 
+    /**
+     * A test on the raw text of one input column, from 'where'. Written as
+     * '<column> <op> <argument>', with op one of:
+     *   - eq: the text equals the argument;
+     *   - prefix: the text starts with the argument;
+     *   - between: the text is a number in the range 'low,high', both
+     *     inclusive; either bound may be left empty;
+     *   - in: the text equals one of the comma-separated arguments.
+     */
+    struct Predicate
+    {
+        enum Op { EQ, PREFIX, BETWEEN, IN };
+        size_t         column;
+        Op             op;
+        vector<string> values;
+        double         low;
+        double         high;
+    };
+
+    /**
+     * Marks an input column that is not loaded into any attribute.
+     */
+    static const size_t NO_ATTRIBUTE = static_cast<size_t>(-1);
+
+    /**
+     * Where a column of the input goes when loading into a target schema:
+     * the dimension or attribute with the given index, or nowhere.
+     */
+    struct TargetColumn
+    {
+        enum Role { DIMENSION, ATTRIBUTE, IGNORED };
+        Role   role;
+        size_t index;
+    };
+
     /**
      * Used to indicate if aio_input should, with respect to
      * the 'error' attribute:
@@ -88,11 +143,15 @@ private:
     string           _inputFilePath;
     vector<string>   _inputPaths;
     vector<int64_t>  _inputInstances;
+    bool             _distributePaths;
+    vector<string>   _inputFiles;
     bool             _thisInstanceReadsData;
     int64_t          _bufferSize;
     bool             _bufferSizeSet;
     int64_t          _header;
     bool             _headerSet;
+    string           _headerPrefix;
+    bool             _headerPrefixSet;
     char             _lineDelimiter;
     bool             _lineDelimiterSet;
     char             _attributeDelimiter;
@@ -104,6 +163,37 @@ private:
     bool             _splitOnDimensionSet;
     Skip             _skip;
     bool             _skipSet;
+    bool             _mmap;
+    bool             _parallelRead;
+    bool             _directIo;
+    int64_t          _readAhead;
+    bool             _readAheadSet;
+    bool             _lineAligned;
+    int64_t          _streamWindow;
+    bool             _streamWindowSet;
+    int64_t          _parseThreads;
+    bool             _parseThreadsSet;
+    vector<TypeId>   _types;
+    bool             _typesSet;
+    ArrayDesc        _target;
+    bool             _targetSet;
+    vector<string>   _mapping;
+    bool             _mappingSet;
+    char             _quote;
+    bool             _formatSet;
+    vector<int64_t>  _columns;
+    bool             _columnsSet;
+    vector<Predicate> _predicates;
+    bool             _predicatesSet;
+    double           _sampleFraction;
+    uint32_t         _sampleSeed;
+    bool             _sampleSet;
+    int64_t          _maxBytes;
+    bool             _maxBytesSet;
+    bool             _writeIndex;
+    bool             _useIndex;
+    string           _resume;
+    bool             _resumeSet;
 
     void checkIfSet(bool alreadySet, const char* kw)
     {
@@ -140,6 +230,178 @@ private:
         _header = header[0];
     }
 
+    void setParamHeaderPrefix(vector<string> prefix)
+    {
+        if(prefix[0].empty())
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "header_prefix must not be empty";
+        }
+        _headerPrefix = prefix[0];
+    }
+
+    void setParamReadAhead(vector<int64_t> readAhead)
+    {
+        if(readAhead[0] < 0 || readAhead[0] > 64)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "read_ahead must be between 0 and 64";
+        }
+        _readAhead = readAhead[0];
+    }
+
+    void setParamStreamWindow(vector<int64_t> window)
+    {
+        if(window[0] < 0)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "stream_window must be non negative";
+        }
+        _streamWindow = window[0];
+    }
+
+    void setParamMaxBytes(vector<int64_t> maxBytes)
+    {
+        if(maxBytes[0] <= 0)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "max_bytes must be positive";
+        }
+        _maxBytes = maxBytes[0];
+    }
+
+    void setParamResume(vector<string> resume)
+    {
+        if (resume[0].empty())
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "resume needs the path of a checkpoint";
+        }
+        _resume = resume[0];
+    }
+
+    void setParamParseThreads(vector<int64_t> threads)
+    {
+        if(threads[0] < 1 || threads[0] > 256)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "parse_threads must be between 1 and 256";
+        }
+        _parseThreads = threads[0];
+    }
+
+    void setParamTypes(vector<string> types)
+    {
+        static char const* const supported[] = { TID_STRING, TID_BOOL, TID_INT8, TID_INT16, TID_INT32, TID_INT64,
+                                                 TID_UINT8, TID_UINT16, TID_UINT32, TID_UINT64, TID_FLOAT, TID_DOUBLE };
+        for (string const& type : types)
+        {
+            if (std::find(std::begin(supported), std::end(supported), type) == std::end(supported))
+            {
+                ostringstream error;
+                error << "types does not support '" << type << "'; use string, bool, int8, int16, int32, int64, "
+                      << "uint8, uint16, uint32, uint64, float or double";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+            _types.push_back(type);
+        }
+    }
+
+    void setParamFormat(vector<string> format)
+    {
+        if (format[0] == "csv")
+        {
+            _quote = '"';
+        }
+        else if (format[0] != "tsv")
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "format may be 'tsv' or 'csv'";
+        }
+    }
+
+    static Predicate parsePredicate(string const& text)
+    {
+        ostringstream error;
+        error << "where predicate '" << text << "' must be '<column> eq|prefix|between|in <argument>'";
+        size_t const opStart = text.find(' ');
+        size_t const argStart = opStart == string::npos ? string::npos : text.find(' ', opStart + 1);
+        if (argStart == string::npos)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+        }
+        Predicate predicate;
+        string const op = text.substr(opStart + 1, argStart - opStart - 1);
+        string const argument = text.substr(argStart + 1);
+        try
+        {
+            predicate.column = boost::lexical_cast<size_t>(text.substr(0, opStart));
+        }
+        catch (boost::bad_lexical_cast const&)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+        }
+        if (op == "eq" || op == "prefix")
+        {
+            predicate.op = op == "eq" ? Predicate::EQ : Predicate::PREFIX;
+            predicate.values.push_back(argument);
+        }
+        else if (op == "in")
+        {
+            predicate.op = Predicate::IN;
+            boost::split(predicate.values, argument, boost::is_any_of(","));
+        }
+        else if (op == "between")
+        {
+            predicate.op = Predicate::BETWEEN;
+            vector<string> bounds;
+            boost::split(bounds, argument, boost::is_any_of(","));
+            if (bounds.size() != 2)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+            try
+            {
+                predicate.low = bounds[0].empty() ? -std::numeric_limits<double>::infinity() : boost::lexical_cast<double>(bounds[0]);
+                predicate.high = bounds[1].empty() ? std::numeric_limits<double>::infinity() : boost::lexical_cast<double>(bounds[1]);
+            }
+            catch (boost::bad_lexical_cast const&)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+        }
+        else
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+        }
+        return predicate;
+    }
+
+    void setParamWhere(vector<string> predicates)
+    {
+        for (string const& text : predicates)
+        {
+            _predicates.push_back(parsePredicate(text));
+        }
+    }
+
+    void setParamColumns(vector<int64_t> columns)
+    {
+        _columns = columns;
+    }
+
+    void setParamMapping(vector<string> mapping)
+    {
+        _mapping = mapping;
+    }
+
+    void setKeywordParamSchema(KeywordParameters const& kwParams, const char* const kw, bool& alreadySet, ArrayDesc& value)
+    {
+        checkIfSet(alreadySet, kw);
+        Parameter kwParam = getKeywordParam(kwParams, kw);
+        if (kwParam) {
+            auto schemaParam = dynamic_cast<OperatorParamSchema*>(kwParam.get());
+            SCIDB_ASSERT(schemaParam != nullptr);
+            value = schemaParam->getSchema();
+            alreadySet = true;
+        } else {
+            LOG4CXX_DEBUG(logger, "aio_input findKeyword null: " << kw);
+        }
+    }
+
     void setParamBufferSize(vector<int64_t> buffer_size)
     {
         if(buffer_size[0] <=8 )
@@ -326,6 +588,59 @@ private:
         }
     }
 
+    double getParamContentDouble(Parameter& param)
+    {
+        double paramContent;
+
+        if(param->getParamType() == PARAM_LOGICAL_EXPRESSION) {
+            ParamType_t& paramExpr = reinterpret_cast<ParamType_t&>(param);
+            paramContent = evaluate(paramExpr->getExpression(), TID_DOUBLE).getDouble();
+        } else {
+            OperatorParamPhysicalExpression* exp =
+                dynamic_cast<OperatorParamPhysicalExpression*>(param.get());
+            SCIDB_ASSERT(exp != nullptr);
+            paramContent = exp->getExpression()->evaluate().getDouble();
+        }
+        return paramContent;
+    }
+
+    /**
+     * sample: takes a fraction, or a fraction and a seed.
+     */
+    void setKeywordParamSample(KeywordParameters const& kwParams)
+    {
+        checkIfSet(_sampleSet, KW_SAMPLE);
+        Parameter kwParam = getKeywordParam(kwParams, KW_SAMPLE);
+        if (!kwParam)
+        {
+            LOG4CXX_DEBUG(logger, "aio_input findKeyword null: " << KW_SAMPLE);
+            return;
+        }
+        int64_t seed = 0;
+        if (kwParam->getParamType() == PARAM_NESTED)
+        {
+            auto group = dynamic_cast<OperatorParamNested*>(kwParam.get());
+            Parameters& gParams = group->getParameters();
+            _sampleFraction = getParamContentDouble(gParams[0]);
+            seed = getParamContentInt64(gParams[1]);
+        }
+        else
+        {
+            _sampleFraction = getParamContentDouble(kwParam);
+        }
+        if (!(_sampleFraction > 0 && _sampleFraction <= 1))
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "sample fraction must be greater than 0 and at most 1";
+        }
+        if (seed < 0 || seed > (int64_t) std::numeric_limits<uint32_t>::max())
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "sample seed must be from 0 to 4294967295";
+        }
+        _sampleSeed = (uint32_t) seed;
+        _sampleSet = true;
+        LOG4CXX_DEBUG(logger, "aio_input setting " << KW_SAMPLE << " to " << _sampleFraction << " seed " << _sampleSeed);
+    }
+
     Parameter getKeywordParam(KeywordParameters const& kwp, const std::string& kw) const
     {
         auto const& kwPair = kwp.find(kw);
@@ -362,11 +677,14 @@ public:
        _singlepath(false),
        _multiplepath(false),
        _inputFilePath(""),
+       _distributePaths(false),
        _thisInstanceReadsData(false),
        _bufferSize(8*1024*1024),
        _bufferSizeSet(false),
        _header(0),
        _headerSet(false),
+       _headerPrefix(""),
+       _headerPrefixSet(false),
        _lineDelimiter('\n'),
        _lineDelimiterSet(false),
        _attributeDelimiter('\t'),
@@ -377,7 +695,32 @@ public:
        _splitOnDimension(false),
        _splitOnDimensionSet(false),
        _skip(AioInputSettings::Skip::NOTHING),
-       _skipSet(false)
+       _skipSet(false),
+       _mmap(false),
+       _parallelRead(false),
+       _directIo(false),
+       _readAhead(0),
+       _readAheadSet(false),
+       _lineAligned(false),
+       _streamWindow(0),
+       _streamWindowSet(false),
+       _parseThreads(1),
+       _parseThreadsSet(false),
+       _typesSet(false),
+       _targetSet(false),
+       _mappingSet(false),
+       _quote(0),
+       _formatSet(false),
+       _columnsSet(false),
+       _predicatesSet(false),
+       _sampleFraction(1.0),
+       _sampleSeed(0),
+       _sampleSet(false),
+       _maxBytes(0),
+       _maxBytesSet(false),
+       _writeIndex(false),
+       _useIndex(false),
+       _resumeSet(false)
     {
         bool pathsSet = false;
         bool instancesSet = false;
@@ -409,6 +752,7 @@ public:
         setKeywordParamString(kwParams, KW_PATHS, pathsSet, &AioInputSettings::setParamPaths);
         setKeywordParamInt64(kwParams, KW_INSTANCES, instancesSet, &AioInputSettings::setParamInstances);
         setKeywordParamInt64(kwParams, KW_HEADER, _headerSet, &AioInputSettings::setParamHeader);
+        setKeywordParamString(kwParams, KW_HEADER_PREFIX, _headerPrefixSet, &AioInputSettings::setParamHeaderPrefix);
         setKeywordParamInt64(kwParams, KW_BUF_SZ, _bufferSizeSet, &AioInputSettings::setParamBufferSize);
         setKeywordParamString(kwParams, KW_LINE_DELIM, _lineDelimiterSet, &AioInputSettings::setParamLineDelim);
         setKeywordParamString(kwParams, KW_ATTR_DELIM, _attributeDelimiterSet, &AioInputSettings::setParamAttrDelim);
@@ -416,6 +760,79 @@ public:
         setKeywordParamBool(kwParams, KW_SPLIT_ON_DIM, _splitOnDimension);
         setKeywordParamInt64(kwParams, KW_CHUNK_SZ, _chunkSizeSet, &AioInputSettings::setParamChunkSize);
         setKeywordParamString(kwParams, KW_SKIP, _skipSet, &AioInputSettings::setSkip);
+        setKeywordParamBool(kwParams, KW_MMAP, _mmap);
+        setKeywordParamBool(kwParams, KW_PARALLEL_READ, _parallelRead);
+        setKeywordParamBool(kwParams, KW_DIRECT_IO, _directIo);
+        setKeywordParamInt64(kwParams, KW_READ_AHEAD, _readAheadSet, &AioInputSettings::setParamReadAhead);
+        setKeywordParamBool(kwParams, KW_LINE_ALIGNED, _lineAligned);
+        setKeywordParamInt64(kwParams, KW_STREAM_WINDOW, _streamWindowSet, &AioInputSettings::setParamStreamWindow);
+        setKeywordParamInt64(kwParams, KW_PARSE_THREADS, _parseThreadsSet, &AioInputSettings::setParamParseThreads);
+        setKeywordParamString(kwParams, KW_TYPES, _typesSet, &AioInputSettings::setParamTypes);
+        setKeywordParamSchema(kwParams, KW_TARGET, _targetSet, _target);
+        setKeywordParamString(kwParams, KW_MAPPING, _mappingSet, &AioInputSettings::setParamMapping);
+        setKeywordParamString(kwParams, KW_FORMAT, _formatSet, &AioInputSettings::setParamFormat);
+        setKeywordParamInt64(kwParams, KW_COLUMNS, _columnsSet, &AioInputSettings::setParamColumns);
+        setKeywordParamString(kwParams, KW_WHERE, _predicatesSet, &AioInputSettings::setParamWhere);
+        setKeywordParamSample(kwParams);
+        setKeywordParamInt64(kwParams, KW_MAX_BYTES, _maxBytesSet, &AioInputSettings::setParamMaxBytes);
+        setKeywordParamBool(kwParams, KW_WRITE_INDEX, _writeIndex);
+        setKeywordParamBool(kwParams, KW_USE_INDEX, _useIndex);
+        setKeywordParamString(kwParams, KW_RESUME, _resumeSet, &AioInputSettings::setParamResume);
+        if (_quote)
+        {
+            if (!_attributeDelimiterSet)
+            {
+                _attributeDelimiter = ',';
+            }
+            if (_attributeDelimiter == _quote || _lineDelimiter == _quote)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "format csv quotes with '\"', which cannot be a delimiter";
+            }
+            // Only the reader, going through the input in order, knows whether
+            // a line delimiter is inside quotes; so it cuts the blocks.
+            _lineAligned = true;
+        }
+        if (_streamWindow > 0)
+        {
+            // Waves are parsed one at a time, so no line may span two of them.
+            _lineAligned = true;
+        }
+        if (_writeIndex)
+        {
+            // The index records where blocks start, which must be lines.
+            _lineAligned = true;
+        }
+        if (_resumeSet)
+        {
+            if (_writeIndex)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "resume cannot be used with write_index";
+            }
+            // A run must end, and the next begin, at a line boundary.
+            _lineAligned = true;
+        }
+        if (_useIndex)
+        {
+            if (!_parallelRead || _writeIndex || _resumeSet)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "use_index requires parallel_read and cannot be used with write_index or resume";
+            }
+            // Every instance starts and ends its share of the file on a line
+            // boundary taken from the index, and cuts its blocks there too.
+            _lineAligned = true;
+        }
+        else if (_lineAligned && _parallelRead)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "line_aligned, stream_window, format csv, write_index and resume cannot be used with parallel_read, unless with use_index";
+        }
+        if (_maxBytesSet && (_parallelRead || _writeIndex))
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "max_bytes cannot be used with parallel_read or write_index";
+        }
+        if (_mmap && _directIo)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "mmap and direct_io cannot both be set";
+        }
 
         for (size_t i= 0; i<nParams; ++i)
         {
@@ -438,13 +855,36 @@ public:
             }
             _singlepath     = true;
             _inputFilePath  = path::expandForRead(path, *query);
-            _thisInstanceReadsData = query->isCoordinator();
+            _thisInstanceReadsData = _parallelRead || query->isCoordinator();
         }
         // multipath vs single path actually doesn't mean there is one file specified, it refers to whether a
         // positional argument is used (which can only specify one path), or the keywords parameter is used.
         // If a single path is specified using the keyword 'paths:', the code path should still be
         // _multipath = true.
-        if(_multiplepath)
+        if(_multiplepath && _parallelRead)
+        {
+            if (_inputPaths.size() != 1 || _inputInstances.size() > 0)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "parallel_read takes a single path and no instances";
+            }
+            if (_singlepath == true)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "Both single path and multiple path were declared.";
+            }
+            _inputFilePath = _inputPaths[0];
+            _thisInstanceReadsData = true;
+        }
+        else if(_multiplepath && _inputInstances.empty())
+        {
+            if (_singlepath == true)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "Both single path and multiple path were declared.";
+            }
+            // Files, directories or glob patterns; the coordinator expands them
+            // and hands the files out to all instances at execution time.
+            _distributePaths = true;
+        }
+        else if(_multiplepath)
         {
             if(_inputInstances.size() != _inputPaths.size())
             {
@@ -493,14 +933,73 @@ public:
         {
             throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "No input file path was provided";
         }
+        if (_targetSet)
+        {
+            if (!_mappingSet)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "target needs a mapping of the input columns";
+            }
+            if (_splitOnDimension || _typesSet || _skipSet)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "target cannot be used with split_on_dimension, types or skip";
+            }
+            if (numAttrsSet && (size_t) _numAttributes != _mapping.size())
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "num_attributes must match the number of columns in mapping";
+            }
+            // Lines that do not fit the target have nowhere to go.
+            _numAttributes = _mapping.size();
+            _skip = AioInputSettings::Skip::ERRORS;
+        }
+        else if (_mappingSet)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "mapping is only used with target";
+        }
         if (_numAttributes == 0)
         {
             throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "num_attributes was not provided";
         }
+        for (Predicate const& predicate : _predicates)
+        {
+            if (predicate.column >= (size_t) _numAttributes)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "where names a column past num_attributes";
+            }
+        }
+        if (_columnsSet)
+        {
+            if (_targetSet)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "columns cannot be used with target; leave columns out of mapping instead";
+            }
+            std::set<int64_t> seen;
+            for (int64_t column : _columns)
+            {
+                if (column < 0 || column >= _numAttributes || !seen.insert(column).second)
+                {
+                    throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "columns must be distinct numbers from 0 to num_attributes-1";
+                }
+            }
+        }
+        if (_typesSet)
+        {
+            if (_splitOnDimension)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "types cannot be used with split_on_dimension";
+            }
+            if (_types.size() != getNumOutputAttributes())
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "types must name one type for each attribute loaded";
+            }
+        }
         if (_bufferSizeSet && !_chunkSizeSet)
         {
             _chunkSize = _bufferSize;
         }
+        if (_thisInstanceReadsData)
+        {
+            _inputFiles.push_back(_inputFilePath);
+        }
     }
 
     bool thisInstanceReadsData()
@@ -508,9 +1007,33 @@ public:
         return _thisInstanceReadsData;
     }
 
-    string const& getInputFilePath() const
+    /**
+     * @return true if the paths are to be expanded into files on the
+     *    coordinator and the files spread over all instances, in which case
+     *    setInputFiles must be called before the files are read.
+     */
+    bool distributesPaths() const
+    {
+        return _distributePaths;
+    }
+
+    vector<string> const& getInputPaths() const
     {
-        return _inputFilePath;
+        return _inputPaths;
+    }
+
+    void setInputFiles(vector<string> const& files)
+    {
+        _inputFiles = files;
+        _thisInstanceReadsData = !files.empty();
+    }
+
+    /**
+     * @return the files this instance reads one after another, if any.
+     */
+    vector<string> const& getInputFiles() const
+    {
+        return _inputFiles;
     }
 
     size_t getBlockSize() const
@@ -533,6 +1056,11 @@ public:
         return _header;
     }
 
+    string const& getHeaderPrefix() const
+    {
+        return _headerPrefix;
+    }
+
     int64_t getChunkSize() const
     {
         return _chunkSize;
@@ -552,6 +1080,237 @@ public:
     {
         return _skip;
     }
+
+    bool getMmap() const
+    {
+        return _mmap;
+    }
+
+    bool getParallelRead() const
+    {
+        return _parallelRead;
+    }
+
+    bool getDirectIo() const
+    {
+        return _directIo;
+    }
+
+    size_t getReadAhead() const
+    {
+        return _readAhead;
+    }
+
+    /**
+     * @return true if the readers write a line index next to every file.
+     */
+    bool getWriteIndex() const
+    {
+        return _writeIndex;
+    }
+
+    /**
+     * @return true if parallel_read divides the file along its line index.
+     */
+    bool getUseIndex() const
+    {
+        return _useIndex;
+    }
+
+    /**
+     * @return the path of the checkpoint a resumable load starts from and
+     *    records its progress in; empty if the load is not resumable.
+     */
+    string const& getResume() const
+    {
+        return _resume;
+    }
+
+    bool getLineAligned() const
+    {
+        return _lineAligned;
+    }
+
+    size_t getStreamWindow() const
+    {
+        return _streamWindow;
+    }
+
+    size_t getParseThreads() const
+    {
+        return _parseThreads;
+    }
+
+    /**
+     * @return how much of each input file to read, past its header: the
+     *    line ending at or after this many bytes is the last; 0 for all.
+     */
+    uint64_t getMaxBytes() const
+    {
+        return _maxBytes;
+    }
+
+    /**
+     * @return the character that quotes fields, 0 if fields are not quoted.
+     */
+    char getQuote() const
+    {
+        return _quote;
+    }
+
+    bool hasTarget() const
+    {
+        return _targetSet;
+    }
+
+    ArrayDesc const& getTarget() const
+    {
+        return _target;
+    }
+
+    /**
+     * Resolve the names in mapping against the target schema. An empty name
+     * drops its column. Every dimension must be named once; attributes that
+     * are not named load as null, so they must be nullable.
+     *
+     * @return where each input column goes.
+     */
+    vector<TargetColumn> getTargetColumns() const
+    {
+        Dimensions const& dims = _target.getDimensions();
+        vector<AttributeDesc> attrs(_target.getAttributes(true).begin(), _target.getAttributes(true).end());
+        vector<bool> dimMapped(dims.size(), false);
+        vector<bool> attrMapped(attrs.size(), false);
+        vector<TargetColumn> columns;
+        for (string const& name : _mapping)
+        {
+            TargetColumn column { TargetColumn::IGNORED, 0 };
+            for (size_t i = 0; i < dims.size() && !name.empty(); ++i)
+            {
+                if (dims[i].hasNameAndAlias(name))
+                {
+                    column = TargetColumn { TargetColumn::DIMENSION, i };
+                }
+            }
+            for (size_t i = 0; i < attrs.size() && !name.empty(); ++i)
+            {
+                if (attrs[i].getName() == name)
+                {
+                    column = TargetColumn { TargetColumn::ATTRIBUTE, i };
+                }
+            }
+            if (!name.empty() && column.role == TargetColumn::IGNORED)
+            {
+                ostringstream error;
+                error << "mapping names '" << name << "', which is not in the target schema";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+            vector<bool>& mapped = column.role == TargetColumn::DIMENSION ? dimMapped : attrMapped;
+            if (column.role != TargetColumn::IGNORED)
+            {
+                if (mapped[column.index])
+                {
+                    ostringstream error;
+                    error << "mapping names '" << name << "' more than once";
+                    throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+                }
+                mapped[column.index] = true;
+            }
+            columns.push_back(column);
+        }
+        for (size_t i = 0; i < dims.size(); ++i)
+        {
+            if (!dimMapped[i])
+            {
+                ostringstream error;
+                error << "mapping must name target dimension '" << dims[i].getBaseName() << "'";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+            if (dims[i].isAutochunked() || dims[i].getChunkOverlap() != 0)
+            {
+                ostringstream error;
+                error << "target dimension '" << dims[i].getBaseName() << "' needs a fixed chunk interval and no overlap";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+        }
+        for (size_t i = 0; i < attrs.size(); ++i)
+        {
+            if (!attrMapped[i] && !attrs[i].isNullable())
+            {
+                ostringstream error;
+                error << "mapping must name target attribute '" << attrs[i].getName() << "', which is not nullable";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << error.str().c_str();
+            }
+        }
+        return columns;
+    }
+
+    vector<Predicate> const& getPredicates() const
+    {
+        return _predicates;
+    }
+
+    /**
+     * @return true if only a sample of the lines is loaded.
+     */
+    bool isSampled() const
+    {
+        return _sampleFraction < 1;
+    }
+
+    /**
+     * @return the 32-bit line hash below which a line is kept: sample's
+     *    fraction of the hash range.
+     */
+    uint64_t getSampleThreshold() const
+    {
+        return (uint64_t) (_sampleFraction * 4294967296.0);
+    }
+
+    uint32_t getSampleSeed() const
+    {
+        return _sampleSeed;
+    }
+
+    /**
+     * @return the number of attributes loaded from the input, before 'error':
+     *    the number of columns selected, or else num_attributes.
+     */
+    size_t getNumOutputAttributes() const
+    {
+        return _columnsSet ? _columns.size() : _numAttributes;
+    }
+
+    /**
+     * @return the number of the input column loaded into attribute i.
+     */
+    size_t getAttributeColumn(size_t i) const
+    {
+        return _columnsSet ? _columns[i] : i;
+    }
+
+    /**
+     * @return for each of the num_attributes input columns, the index of the
+     *    attribute it is loaded into, or NO_ATTRIBUTE.
+     */
+    vector<size_t> getColumnAttributes() const
+    {
+        vector<size_t> attributes(_numAttributes, NO_ATTRIBUTE);
+        for (size_t i = 0; i < getNumOutputAttributes(); ++i)
+        {
+            attributes[getAttributeColumn(i)] = i;
+        }
+        return attributes;
+    }
+
+    /**
+     * @return the type of attribute i: the one given with 'types', string
+     *    if none were given.
+     */
+    TypeId getAttributeType(size_t i) const
+    {
+        return _types.empty() ? TypeId(TID_STRING) : _types[i];
+    }
 };
 
 }
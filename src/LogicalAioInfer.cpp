@@ -0,0 +1,134 @@
+/*
+**
+* BEGIN_COPYRIGHT
+*
+* Copyright (C) 2008-2020 Paradigm4 Inc.
+* All Rights Reserved.
+*
+* accelerated_io_tools is a plugin for SciDB, an Open Source Array DBMS maintained
+* by Paradigm4. See http://www.paradigm4.com/
+*
+* accelerated_io_tools is free software: you can redistribute it and/or modify
+* it under the terms of the AFFERO GNU General Public License as published by
+* the Free Software Foundation.
+*
+* accelerated_io_tools is distributed "AS-IS" AND WITHOUT ANY WARRANTY OF ANY KIND,
+* INCLUDING ANY IMPLIED WARRANTY OF MERCHANTABILITY,
+* NON-INFRINGEMENT, OR FITNESS FOR A PARTICULAR PURPOSE. See
+* the AFFERO GNU General Public License for the complete license terms.
+*
+* You should have received a copy of the AFFERO GNU General Public License
+* along with accelerated_io_tools.  If not, see <http://www.gnu.org/licenses/agpl-3.0.html>
+*
+* END_COPYRIGHT
+*/
+
+#include <query/LogicalOperator.h>
+#include <array/Metadata.h>  // for addEmptyTagAttribute
+
+#include "AioInputSettings.h"
+namespace scidb
+{
+
+/**
+ * aio_infer takes the reading and splitting parameters of aio_input and
+ * returns one cell per input column: the narrowest type that converts most
+ * of its values, the length of the longest value, the share of lines where
+ * it is empty or missing, the share of its values the type fails on, and
+ * an estimate of the number of distinct values.
+ */
+class LogicalAioInfer : public  LogicalOperator
+{
+public:
+    LogicalAioInfer(const std::string& logicalName, const std::string& alias):
+        LogicalOperator(logicalName, alias)
+    {
+    }
+
+    static PlistSpec const* makePlistSpec()
+    {
+        static PlistSpec argSpec {
+            { "", // positionals
+              RE(RE::STAR, {
+                 RE(PP(PLACEHOLDER_CONSTANT, TID_STRING))
+              })
+            },
+            { KW_PATHS, RE(RE::OR, {
+                           RE(PP(PLACEHOLDER_EXPRESSION, TID_STRING)),
+                           RE(RE::GROUP, {
+                              RE(PP(PLACEHOLDER_EXPRESSION, TID_STRING)),
+                              RE(RE::PLUS, {
+                                 RE(PP(PLACEHOLDER_EXPRESSION, TID_STRING))
+                              })
+                           })
+                        })
+            },
+            { KW_INSTANCES, RE(RE::OR, {
+                            RE(PP(PLACEHOLDER_EXPRESSION, TID_INT64)),
+                            RE(RE::GROUP, {
+                                   RE(PP(PLACEHOLDER_EXPRESSION, TID_INT64)),
+                                   RE(RE::PLUS, {
+                                      RE(PP(PLACEHOLDER_EXPRESSION, TID_INT64))
+                                   })
+                              })
+                           })
+            },
+            { KW_BUF_SZ, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_HEADER, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_HEADER_PREFIX, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_LINE_DELIM, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_ATTR_DELIM, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_NUM_ATTR, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_CHUNK_SZ, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_MMAP, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_PARALLEL_READ, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_DIRECT_IO, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_READ_AHEAD, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_LINE_ALIGNED, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_STREAM_WINDOW, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_PARSE_THREADS, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_FORMAT, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_WHERE, RE(RE::OR, {
+                           RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                           RE(RE::GROUP, {
+                              RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                              RE(RE::PLUS, {
+                                 RE(PP(PLACEHOLDER_CONSTANT, TID_STRING))
+                              })
+                           })
+                        })
+            },
+            { KW_SAMPLE, RE(RE::OR, {
+                            RE(PP(PLACEHOLDER_CONSTANT, TID_DOUBLE)),
+                            RE(RE::GROUP, {
+                                   RE(PP(PLACEHOLDER_CONSTANT, TID_DOUBLE)),
+                                   RE(PP(PLACEHOLDER_CONSTANT, TID_INT64))
+                              })
+                           })
+            },
+            { KW_MAX_BYTES, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_USE_INDEX, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) }
+        };
+        return &argSpec;
+    }
+
+    ArrayDesc inferSchema(std::vector< ArrayDesc> schemas, shared_ptr< Query> query)
+    {
+        AioInputSettings settings (_parameters, _kwParameters, true, query);
+        size_t const numColumns = settings.getNumAttributes();
+        vector<DimensionDesc> dimensions(1);
+        dimensions[0] = DimensionDesc("column_no", 0, 0, numColumns-1, numColumns-1, numColumns, 0);
+        Attributes attributes;
+        attributes.push_back(AttributeDesc("type",          TID_STRING, 0, CompressorType::NONE));
+        attributes.push_back(AttributeDesc("max_length",    TID_INT64,  0, CompressorType::NONE));
+        attributes.push_back(AttributeDesc("null_ratio",    TID_DOUBLE, 0, CompressorType::NONE));
+        attributes.push_back(AttributeDesc("failure_ratio", TID_DOUBLE, 0, CompressorType::NONE));
+        attributes.push_back(AttributeDesc("distinct",      TID_INT64,  0, CompressorType::NONE));
+        attributes.addEmptyTagAttribute();
+        return ArrayDesc("aio_infer", attributes, dimensions, createDistribution(dtUndefined), query->getDefaultArrayResidency());
+    }
+};
+
+REGISTER_LOGICAL_OPERATOR_FACTORY(LogicalAioInfer, "aio_infer");
+
+} // emd namespace scidb
@@ -68,12 +68,74 @@ public:
             },
             { KW_BUF_SZ, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
             { KW_HEADER, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_HEADER_PREFIX, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
             { KW_LINE_DELIM, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
             { KW_ATTR_DELIM, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
             { KW_NUM_ATTR, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
             { KW_CHUNK_SZ, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
             { KW_SPLIT_ON_DIM, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
-            { KW_SKIP, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) }
+            { KW_SKIP, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_MMAP, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_PARALLEL_READ, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_DIRECT_IO, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_READ_AHEAD, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_LINE_ALIGNED, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_STREAM_WINDOW, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_PARSE_THREADS, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_TYPES, RE(RE::OR, {
+                           RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                           RE(RE::GROUP, {
+                              RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                              RE(RE::PLUS, {
+                                 RE(PP(PLACEHOLDER_CONSTANT, TID_STRING))
+                              })
+                           })
+                        })
+            },
+            { KW_FORMAT, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_COLUMNS, RE(RE::OR, {
+                            RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)),
+                            RE(RE::GROUP, {
+                                   RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)),
+                                   RE(RE::PLUS, {
+                                      RE(PP(PLACEHOLDER_CONSTANT, TID_INT64))
+                                   })
+                              })
+                           })
+            },
+            { KW_WHERE, RE(RE::OR, {
+                           RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                           RE(RE::GROUP, {
+                              RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                              RE(RE::PLUS, {
+                                 RE(PP(PLACEHOLDER_CONSTANT, TID_STRING))
+                              })
+                           })
+                        })
+            },
+            { KW_SAMPLE, RE(RE::OR, {
+                            RE(PP(PLACEHOLDER_CONSTANT, TID_DOUBLE)),
+                            RE(RE::GROUP, {
+                                   RE(PP(PLACEHOLDER_CONSTANT, TID_DOUBLE)),
+                                   RE(PP(PLACEHOLDER_CONSTANT, TID_INT64))
+                              })
+                           })
+            },
+            { KW_MAX_BYTES, RE(PP(PLACEHOLDER_CONSTANT, TID_INT64)) },
+            { KW_WRITE_INDEX, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_USE_INDEX, RE(PP(PLACEHOLDER_CONSTANT, TID_BOOL)) },
+            { KW_RESUME, RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)) },
+            { KW_TARGET, RE(PP(PLACEHOLDER_SCHEMA)) },
+            { KW_MAPPING, RE(RE::OR, {
+                           RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                           RE(RE::GROUP, {
+                              RE(PP(PLACEHOLDER_CONSTANT, TID_STRING)),
+                              RE(RE::PLUS, {
+                                 RE(PP(PLACEHOLDER_CONSTANT, TID_STRING))
+                              })
+                           })
+                        })
+            }
         };
         return &argSpec;
     }
@@ -81,7 +143,23 @@ public:
     ArrayDesc inferSchema(std::vector< ArrayDesc> schemas, shared_ptr< Query> query)
     {
         AioInputSettings settings (_parameters, _kwParameters, true, query);
-        size_t numRequestedAttributes = settings.getNumAttributes();
+        if (settings.hasTarget())
+        {
+            // The target's own shape, with cells bucketed by its chunks but not
+            // yet distributed: the optimizer adds the one SG needed to store it.
+            settings.getTargetColumns();
+            ArrayDesc const& target = settings.getTarget();
+            Attributes targetAttributes;
+            for (const auto& attr : target.getAttributes(/*excludeEbm:*/true))
+            {
+                targetAttributes.push_back(AttributeDesc(attr.getName(), attr.getType(),
+                                                         attr.isNullable() ? AttributeDesc::IS_NULLABLE : 0,
+                                                         CompressorType::NONE));
+            }
+            targetAttributes.addEmptyTagAttribute();
+            return ArrayDesc("aio_input", targetAttributes, target.getDimensions(), createDistribution(dtUndefined), query->getDefaultArrayResidency());
+        }
+        size_t numRequestedAttributes = settings.getNumOutputAttributes();
         size_t requestedChunkSize = settings.getChunkSize();
         size_t const nInstances = query->getInstancesCount();
         vector<DimensionDesc> dimensions(3);
@@ -100,8 +178,8 @@ public:
             {
                 ostringstream attname;
                 attname<<"a";
-                attname<<i;
-                attributes.push_back(AttributeDesc(attname.str(),  TID_STRING, AttributeDesc::IS_NULLABLE, CompressorType::NONE));
+                attname<<settings.getAttributeColumn(i);
+                attributes.push_back(AttributeDesc(attname.str(),  settings.getAttributeType(i), AttributeDesc::IS_NULLABLE, CompressorType::NONE));
             }
             attributes.push_back(AttributeDesc("error", TID_STRING, AttributeDesc::IS_NULLABLE, CompressorType::NONE));
         }
@@ -35,17 +35,57 @@
 #include <array/SinglePassArray.h>
 #include <array/PinBuffer.h>
 #include <system/Sysinfo.h>
+#include <util/Job.h>
+#include <util/JobQueue.h>
 #include <network/Network.h>
 
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <exception>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <dirent.h>
 #include <fcntl.h>
+#include <glob.h>
+#include <locale.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
 #include <sys/select.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef USE_IO_URING
+#include <liburing.h>
+#endif
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include <MurmurHash/MurmurHash3.h>
+
+#include "AioCollectives.h"
+#include "AioDelimiterScan.h"
 #include "AioInputSettings.h"
 
 using std::make_shared;
@@ -100,232 +140,158 @@ public:
     }
 };
 
-class BinFileSplitArray : public SinglePassArray
+/**
+ * Read from the input, allowing query cancellation to interrupt
+ * the read, ensuring that array locks are cleaned-up and the query
+ * aborted appropriately.
+ *
+ * @param fd The input file's descriptor.
+ * @param buf The buffer into which to read data.
+ * @param count The size of the buffer in bytes.
+ * @param isFifo True if fd refers to a FIFO; determined once by the caller
+ *    rather than with an fstat on every read.
+ * @param query A weak pointer to the query.
+ */
+static ssize_t scidb_read(int fd,
+                          void* buffer,
+                          size_t const count,
+                          bool const isFifo,
+                          std::weak_ptr<Query> query)
 {
-private:
-    typedef SinglePassArray super;
-    size_t _rowIndex;
-    Address _chunkAddress;
-    MemChunk _chunk;
-    weak_ptr<Query> _query;
-    size_t const _fileBlockSize;
-    size_t const _chunkOverheadSize;
-    bool         _endOfFile;
-    char*        _bufPointer;
-    uint32_t*    _sizePointer;
-    int          _inputFile;
-    size_t const _nInstances;
-    ssize_t       _chunkNo;
-
-public:
-    BinFileSplitArray(ArrayDesc const& schema,
-                      shared_ptr<Query>& query,
-                      shared_ptr<AioInputSettings> settings):
-        super(schema),
-        _rowIndex(0),
-        _chunkAddress(0, Coordinates(3,0)),
-        _chunk(SCIDB_CODE_LOC),
-        _query(query),
-        _fileBlockSize(settings->getBlockSize()),
-        _chunkOverheadSize( getChunkOverheadSize() ),
-        _endOfFile(false),
-        _inputFile(-1),  // invalid FD
-        _nInstances(query->getInstancesCount()),
-        _chunkNo(0)
-    {
-        super::setEnforceHorizontalIteration(true);
-        _chunkAddress.coords[2] = query->getInstanceID();
-        try
-        {
-            _chunk.allocate(_chunkOverheadSize + _fileBlockSize,
-                            AllocType::chunk, SCIDB_CODE_LOC);
+    ssize_t total = 0;
+    size_t rdCnt = count;
+    fd_set readFdSet;
+    auto buf = static_cast<char*>(buffer);
+    do {
+        FD_ZERO(&readFdSet);
+        FD_SET(fd, &readFdSet);
+        // select can change the timeval parameter, so make a new
+        // copy of it each time around the loop.
+        timeval rdTimeout{/*tv_sec:*/1, /*tv_usec:*/0};
+        int fds_ready = select(fd+1, &readFdSet, nullptr, nullptr, &rdTimeout);
+        if (fds_ready > 0) {
+            if (FD_ISSET(fd, &readFdSet)) {
+                ssize_t nb = ::read(fd, buf, rdCnt);
+                if (nb > 0) {
+                    // Making progress on the read.
+                    total += nb;
+                    rdCnt -= nb;
+                    buf += nb;
+                }
+                else if (nb == 0) {
+                    if (isFifo && total == 0) {
+                        // We haven't read any data from the FIFO yet.  To preserve
+                        // the previous aio_input behavior, don't return, and try
+                        // again.  But first, check the query to be sure we haven't
+                        // aborted.  If we have aborted, then this call will throw.
+                        Query::getValidQueryPtr(query);
+                        continue;
+                    }
+                    // else, we've read data to the end of the FIFO or file.
+                    return total;
+                }
+                else {  // nb < 0
+                    if (errno != EAGAIN) {
+                        // Some other signal interrupted, so return what we have.
+                        return total;
+                    }
+                    // else try again on EAGAIN
+                }
+            }
+            else {
+                // else some other FD is set.  This shouldn't be possible
+                // at the commit where this scidb_read was introduced
+                // because we passed on only one FD to select().
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION)
+                    << "Unexpected file descriptor in aio_input() has data available";
+            }
         }
-        catch(...)
-        {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "File splitter cannot allocate memory";
+        else if (fds_ready == 0) {
+            // No fds ready, but maybe the query died, so check
+            // that.  If the query is dead, then this will throw,
+            // prompting the input operation to terminate.
+            Query::getValidQueryPtr(query);
         }
-        _bufPointer = (char*) _chunk.getWriteData();
-        RLEPayload::PayloadHeader* hdr = (RLEPayload::PayloadHeader*) _bufPointer;
-        hdr->_magic = RLE_PAYLOAD_MAGIC;
-        hdr->_nSegs = 1;
-        hdr->_elemSize = 0;
-        hdr->_dataSize = _fileBlockSize + 5 + sizeof(varpart_offset_t);
-        hdr->_varOffs = sizeof(varpart_offset_t);
-        hdr->_isBoolean = 0;
-        PayloadSegment* seg = (PayloadSegment*) (hdr+1);
-        *seg =  PayloadSegment(0,0,false,false);
-        ++seg;
-        *seg =  PayloadSegment(1,0,false,false);
-        varpart_offset_t* vp =  (varpart_offset_t*) (seg+1);
-        *vp = 0;
-        uint8_t* sizeFlag = (uint8_t*) (vp+1);
-        *sizeFlag =0;
-        _sizePointer = (uint32_t*) (sizeFlag + 1);
-        *_sizePointer = (uint32_t) _fileBlockSize;
-        _bufPointer = (char*) (_sizePointer+1);
-        string const& filePath = settings->getInputFilePath();
-        _inputFile = openFile(filePath, query->getInstanceID());
-        int const header = settings->getHeader();
-        if (header > 0) {
-            skipHeader(_inputFile, header, settings->getLineDelimiter(), query);
+        else {  // else fds_ready < 0
+            // An error occurred during select().
+            return total;
         }
-    }
+    } while (rdCnt > 0);
 
-    /**
-     * Open the input file for reading.
-     *
-     * @param filePath The path to the FIFO, pipe, or file to read input from.
-     * @param instanceId The ID of this instance, used only for the exception message
-     *    should this openFile fail.
-     */
-    static int openFile(std::string const& filePath,
-                        InstanceID instanceId)
-    {
-        // Mark this FD as non-blocking because filePath could refer to any
-        // file-like device and we must be able to periodically check for
-        // a valid query.  If we marked this as blocking, then we will end
-        // up stuck forever in a read() in cases where pipes that don't
-        // have data yet in them but the query has been cancelled.
-        auto fd = open(filePath.c_str(), O_RDONLY | O_NONBLOCK);
+    return total;
+}
 
-        if (fd == -1) {
-	    int err = errno;
-            ostringstream errorMsg;
-            errorMsg << "cannot open file '" << filePath << "' on instance " << instanceId
-		     << " (errno=" << err << ", '" << strerror(err) << "')";
-            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << errorMsg.str().c_str();
-        }
+static bool isFifo(int fd)
+{
+    struct stat fdStat;
+    return fstat(fd, &fdStat) == 0 && S_ISFIFO(fdStat.st_mode);
+}
 
-        return fd;
-    }
+/**
+ * Used as a reader's limit when it should read to the end of the input.
+ */
+static uint64_t const READ_TO_END = std::numeric_limits<uint64_t>::max();
 
-    virtual ~BinFileSplitArray()
-    {
-        if (_inputFile != -1)
-        {
-            ::close(_inputFile);
-        }
-    }
+/**
+ * @return the offset just past the last byte a reader starting at start
+ *    and limited to limit bytes may read from a file of size fileSize.
+ */
+static off_t rangeEnd(off_t start, uint64_t limit, off_t fileSize)
+{
+    return (start >= fileSize || limit >= (uint64_t) (fileSize - start)) ? fileSize : start + limit;
+}
 
-    size_t getCurrentRowIndex() const
-    {
-        return _rowIndex;
-    }
+/**
+ * Class AioReader
+ *
+ * The source of the raw bytes that BinFileSplitArray cuts into blocks.
+ * Implementations differ only in how they get the bytes off the device.
+ */
+class AioReader : public boost::noncopyable
+{
+public:
+    virtual ~AioReader()
+    {}
 
     /**
-     * Read past some number of lines from the input file, regarding
-     * them as a header containing no data to load.
+     * Copy the next count bytes of input into buf.
      *
-     * @param fd The input file's descriptor.
-     * @param linesToSkip The number of lines in the header to disregard.
-     * @param lineDelim The character delimiting lines in the input file.
-     * @param query A weak pointer to the query.
+     * @return the number of bytes copied; fewer than count only once the
+     *    end of the input has been reached, 0 after that.
      */
-    static void skipHeader(int fd,
-                           int linesToSkip,
-                           char lineDelim,
-                           std::weak_ptr<Query> query)
-    {
-        // Linux implementation of getdelim() reads a single byte-at-a-time
-        // from the input.  Do that for now, optimizing later if we need to.
-        char buf;
-        int linesSkipped = 0;
-        do {
-            auto result = scidb_read(fd, &buf, 1, query);
-            if (result == 1 && buf == lineDelim) {
-                ++linesSkipped;
-            }
-        } while (linesSkipped < linesToSkip);
-    }
+    virtual size_t read(char* buf, size_t count) = 0;
+};
 
-    /**
-     * Read from the input, allowing query cancellation to interrupt
-     * the read, ensuring that array locks are cleaned-up and the query
-     * aborted appropriately.
-     *
-     * @param fd The input file's descriptor.
-     * @param buf The buffer into which to read data.
-     * @param count The size of the buffer in bytes.
-     * @param query A weak pointer to the query.
-     */
-    static ssize_t scidb_read(int fd,
-                              void* buffer,
-                              size_t const count,
-                              std::weak_ptr<Query> query)
-    {
-        ssize_t total = 0;
-        size_t rdCnt = count;
-        struct stat fdStat;
-        fstat(fd, &fdStat);
-        const bool isFifo = S_ISFIFO(fdStat.st_mode);
-        fd_set readFdSet;
-        auto buf = static_cast<char*>(buffer);
-        do {
-            FD_ZERO(&readFdSet);
-            FD_SET(fd, &readFdSet);
-            // select can change the timeval parameter, so make a new
-            // copy of it each time around the loop.
-            timeval rdTimeout{/*tv_sec:*/1, /*tv_usec:*/0};
-            int fds_ready = select(fd+1, &readFdSet, nullptr, nullptr, &rdTimeout);
-            if (fds_ready > 0) {
-                if (FD_ISSET(fd, &readFdSet)) {
-                    ssize_t nb = ::read(fd, buf, rdCnt);
-                    if (nb > 0) {
-                        // Making progress on the read.
-                        total += nb;
-                        rdCnt -= nb;
-                        buf += nb;
-                    }
-                    else if (nb == 0) {
-                        if (isFifo && total == 0) {
-                            // We haven't read any data from the FIFO yet.  To preserve
-                            // the previous aio_input behavior, don't return, and try
-                            // again.  But first, check the query to be sure we haven't
-                            // aborted.  If we have aborted, then this call will throw.
-                            Query::getValidQueryPtr(query);
-                            continue;
-                        }
-                        // else, we've read data to the end of the FIFO or file.
-                        return total;
-                    }
-                    else {  // nb < 0
-                        if (errno != EAGAIN) {
-                            // Some other signal interrupted, so return what we have.
-                            return total;
-                        }
-                        // else try again on EAGAIN
-                    }
-                }
-                else {
-                    // else some other FD is set.  This shouldn't be possible
-                    // at the commit where this scidb_read was introduced
-                    // because we passed on only one FD to select().
-                    throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION)
-                        << "Unexpected file descriptor in aio_input() has data available";
-                }
-            }
-            else if (fds_ready == 0) {
-                // No fds ready, but maybe the query died, so check
-                // that.  If the query is dead, then this will throw,
-                // prompting the input operation to terminate.
-                Query::getValidQueryPtr(query);
-            }
-            else {  // else fds_ready < 0
-                // An error occurred during select().
-                return total;
-            }
-        } while (rdCnt > 0);
+/**
+ * Synchronous select()/read() reader. Works with any file-like object,
+ * including FIFOs and pipes.
+ */
+class FdReader : public AioReader
+{
+private:
+    int const       _fd;
+    bool const      _isFifo;
+    bool            _eof;
+    uint64_t        _remaining;
+    weak_ptr<Query> _query;
 
-        return total;
-    }
+public:
+    FdReader(int fd, uint64_t limit, weak_ptr<Query> query):
+        _fd(fd),
+        _isFifo(isFifo(fd)),
+        _eof(false),
+        _remaining(limit),
+        _query(query)
+    {}
 
-    bool moveNext(size_t rowIndex)
+    size_t read(char* buf, size_t count) override
     {
-        if (_endOfFile) {
-            return false;
+        if (_eof || _remaining == 0)
+        {
+            return 0;
         }
-        ssize_t numBytes = scidb_read(_inputFile, _bufPointer, _fileBlockSize, _query);
-
+        count = std::min<uint64_t>(count, _remaining);
+        ssize_t numBytes = scidb_read(_fd, buf, count, _isFifo, _query);
         if (numBytes == -1) {
             // Error, inspect errno and abort the query with an exception.
             ostringstream oss;
@@ -334,381 +300,3851 @@ public:
             throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION)
                 << oss.str().c_str();
         }
-
-        if (numBytes != _fileBlockSize) {
-            _endOfFile = true;
-            ::close(_inputFile);
-            _inputFile = -1;
-            if (numBytes == 0) {
-                return false;
-            }
-            *_sizePointer = (uint32_t) numBytes;
-        }
-        ++_rowIndex;
-        return true;
-    }
-
-    ConstChunk const& getChunk(AttributeID attr, size_t rowIndex)
-    {
-        _chunkAddress.coords[1] = (_rowIndex  - 1 + _chunkAddress.coords[2]) % _nInstances;
-        if(_chunkAddress.coords[1] == 0 && _rowIndex > 1)
+        if ((size_t) numBytes != count)
         {
-            _chunkNo++;
+            // A FIFO that has been drained would make the next scidb_read()
+            // wait for a writer forever, so never read past a short read.
+            _eof = true;
         }
-        _chunkAddress.coords[0] = _chunkNo;
-        shared_ptr<Query> query = Query::getValidQueryPtr(_query);
-        _chunk.initialize(this, &super::getArrayDesc(), _chunkAddress, CompressorType::NONE);
-        return _chunk;
+        _remaining -= numBytes;
+        return numBytes;
     }
 };
 
-class AIOOutputWriter : public boost::noncopyable
+#ifdef USE_IO_URING
+/**
+ * Reads a regular file through io_uring, keeping several block-sized reads
+ * in flight ahead of the consumer. Blocks are handed out in file order, and
+ * each buffer is resubmitted for the next unread part of the file as soon as
+ * it has been drained, so the device stays busy while earlier blocks are
+ * redistributed.
+ */
+class UringReader : public AioReader
 {
 private:
-    shared_ptr<Array> const _output;
-    Coordinates _outputPosition;
-    size_t const _numLiveAttributes;
-    size_t const _outputLineSize;
-    size_t const _outputChunkSize;
-    vector<shared_ptr<ArrayIterator> > _outputArrayIterators;
-    vector<shared_ptr<ChunkIterator> > _outputChunkIterators;
-    bool _splitOnDimension;
-    size_t _outputColumn;
-    char const _attributeDelimiter;
-    vector<Value> _buf;
-    ostringstream _errorBuf;
-    Value _errorBufVal;
-    Coordinate _outputPositionLimit;
+    struct Slot
+    {
+        char*  buf;
+        off_t  offset;  // file offset of the first byte of this slot
+        size_t wanted;  // bytes this slot covers; 0 once the file is exhausted
+        size_t filled;  // bytes read so far
+        bool   done;
+    };
 
-public:
-    AIOOutputWriter(ArrayDesc const& schema, shared_ptr<Query>& query, bool splitOnDimension, char const attDelimiter):
-        _output(std::make_shared<MemArray>(schema,query)),
-        _outputPosition( splitOnDimension ? 4 : 3, 0),
-        _numLiveAttributes(schema.getAttributes(true).size()),
-        _outputLineSize(splitOnDimension ? schema.getDimensions()[3].getChunkInterval() : _numLiveAttributes),
-        _outputChunkSize(schema.getDimensions()[0].getChunkInterval()),
-        _outputArrayIterators(_numLiveAttributes),
-        _outputChunkIterators(_numLiveAttributes),
-        _splitOnDimension(splitOnDimension),
-        _outputColumn(0),
-        _attributeDelimiter(attDelimiter),
-        _buf(_outputLineSize-1)
+    io_uring        _ring;
+    bool            _ringReady;
+    int const       _fd;
+    size_t const    _blockSize;
+    off_t const     _endOffset;
+    off_t           _nextOffset;
+    vector<Slot>    _slots;
+    size_t          _head;
+    size_t          _headPos;
+    size_t          _inFlight;
+    weak_ptr<Query> _query;
+
+    UringReader(int fd, size_t blockSize, off_t startOffset, off_t endOffset, weak_ptr<Query> query):
+        _ringReady(false),
+        _fd(fd),
+        _blockSize(blockSize),
+        _endOffset(endOffset),
+        _nextOffset(startOffset),
+        _head(0),
+        _headPos(0),
+        _inFlight(0),
+        _query(query)
+    {}
+
+    void submit(size_t index)
     {
-/*        for(AttributeID i =0; i<_numLiveAttributes; ++i)
+        Slot& slot = _slots[index];
+        io_uring_sqe* sqe = io_uring_get_sqe(&_ring);
+        if (sqe == nullptr)
         {
-            _outputArrayIterators[i] = _output->getIterator(i);
-            }*/
-        for (const auto& attr : schema.getAttributes(/*excludeEbm:*/true))
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "[defensive] io_uring submission queue is full";
+        }
+        io_uring_prep_read(sqe, _fd, slot.buf + slot.filled, slot.wanted - slot.filled, slot.offset + slot.filled);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(index));
+        int const ret = io_uring_submit(&_ring);
+        if (ret < 0)
         {
-            _outputArrayIterators[attr.getId()] = _output->getIterator(attr);
+            ostringstream oss;
+            oss << "aio_input() io_uring submit failed (" << strerror(-ret) << ")";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
         }
+        ++_inFlight;
     }
 
-    void newChunk (Coordinates const& inputChunkPosition, shared_ptr<Query>& query)
+    void startSlot(size_t index)
     {
-        _outputPosition[0] = inputChunkPosition[0] * _outputChunkSize;
-        _outputPositionLimit = _outputPosition[0] + _outputChunkSize;
-        _outputPosition[1] = inputChunkPosition[1];
-        _outputPosition[2] = inputChunkPosition[2];
-        if(_splitOnDimension)
-        {
-            _outputPosition[3] = 0;
-        }
-        for(AttributeID i =0; i<_numLiveAttributes; ++i)
+        Slot& slot = _slots[index];
+        slot.offset = _nextOffset;
+        slot.wanted = _nextOffset < _endOffset ? std::min<size_t>(_blockSize, _endOffset - _nextOffset) : 0;
+        slot.filled = 0;
+        slot.done = (slot.wanted == 0);
+        _nextOffset += slot.wanted;
+        if (!slot.done)
         {
-            if(_outputChunkIterators[i].get())
-            {
-                _outputChunkIterators[i]->flush();
-            }
-            _outputChunkIterators[i] = _outputArrayIterators[i]->newChunk(_outputPosition).getIterator(query,
-                i == 0 ? ChunkIterator::SEQUENTIAL_WRITE : ChunkIterator::SEQUENTIAL_WRITE | ChunkIterator::NO_EMPTY_CHECK);
+            submit(index);
         }
     }
 
-    void writeValue (char const* start, char const* end)
+    void complete(io_uring_cqe* cqe)
     {
-        if(_outputPosition[0] >= _outputPositionLimit)
+        size_t const index = reinterpret_cast<size_t>(io_uring_cqe_get_data(cqe));
+        int const res = cqe->res;
+        io_uring_cqe_seen(&_ring, cqe);
+        --_inFlight;
+        Slot& slot = _slots[index];
+        if (res == -EAGAIN || res == -EINTR)
         {
-            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "The chunk size is too small for the current block size. Lower the block size or increase chunk size";
+            submit(index);
         }
-        if(_outputColumn < _outputLineSize - 1)
+        else if (res < 0)
         {
-            Value& buf = _buf[_outputColumn];
-            buf.setSize<Value::IGNORE_DATA>(end - start + 1);
-            char* d = buf.getData<char>();
-            memcpy(d, start, end-start);
-            d[(end-start)]=0;
-            if(_splitOnDimension)
-            {
-                _outputChunkIterators[0] -> setPosition(_outputPosition);
-                _outputChunkIterators[0] -> writeItem(buf);
-                ++(_outputPosition[3]);
-            }
-            else
-            {
-                _outputChunkIterators[_outputColumn] -> setPosition(_outputPosition);
-                _outputChunkIterators[_outputColumn] -> writeItem(buf);
-            }
+            ostringstream oss;
+            oss << "aio_input() error reading from fd, errno=" << -res << " (" << strerror(-res) << ")";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
         }
-        else if (_outputColumn == _outputLineSize - 1)
+        else if (res == 0)
         {
-            string value(start, end-start);
-            _errorBuf << "long" << _attributeDelimiter << value;
+            // The file shrank since we looked at it; treat this as its end.
+            slot.wanted = slot.filled;
+            slot.done = true;
         }
         else
         {
-            string value(start, end-start);
-            _errorBuf << _attributeDelimiter << value;
+            slot.filled += res;
+            if (slot.filled < slot.wanted)
+            {
+                submit(index);
+            }
+            else
+            {
+                slot.done = true;
+            }
         }
-        ++_outputColumn;
     }
 
-    void endLine()
+    void waitForHead()
     {
-        if(_outputColumn < _outputLineSize - 1)
+        while (!_slots[_head].done)
         {
-            _errorBufVal.setNull();
-            if(_splitOnDimension)
+            io_uring_cqe* cqe = nullptr;
+            __kernel_timespec timeout{/*tv_sec:*/1, /*tv_nsec:*/0};
+            int const ret = io_uring_wait_cqe_timeout(&_ring, &cqe, &timeout);
+            if (ret == -ETIME || ret == -EINTR)
             {
-                while (_outputColumn < _outputLineSize - 1)
-                {
-                    _outputChunkIterators[0] -> setPosition(_outputPosition);
-                    _outputChunkIterators[0] -> writeItem(_errorBufVal);
-                    ++(_outputPosition[3]);
-                    ++_outputColumn;
-                }
+                // Nothing completed yet; make sure the query is still alive.
+                Query::getValidQueryPtr(_query);
+                continue;
             }
-            else
+            if (ret < 0)
             {
-                while (_outputColumn < _outputLineSize - 1)
-                {
-                    _outputChunkIterators[_outputColumn] -> setPosition(_outputPosition);
-                    _outputChunkIterators[_outputColumn] -> writeItem(_errorBufVal);
-                    ++_outputColumn;
-                }
+                ostringstream oss;
+                oss << "aio_input() io_uring wait failed (" << strerror(-ret) << ")";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
             }
-            _errorBuf << "short";
+            complete(cqe);
+        }
+    }
+
+public:
+    /**
+     * @return a reader for at most limit bytes of fd, starting at its current
+     *    offset, or nullptr if fd is not a regular file or io_uring is not
+     *    available on this host.
+     */
+    static std::unique_ptr<AioReader> create(int fd, size_t blockSize, size_t depth, uint64_t limit, weak_ptr<Query> query)
+    {
+        struct stat fdStat;
+        if (fstat(fd, &fdStat) != 0 || !S_ISREG(fdStat.st_mode))
+        {
+            return nullptr;
+        }
+        off_t const startOffset = lseek(fd, 0, SEEK_CUR);
+        if (startOffset < 0)
+        {
+            return nullptr;
+        }
+        off_t const endOffset = rangeEnd(startOffset, limit, fdStat.st_size);
+        std::unique_ptr<UringReader> reader(new UringReader(fd, blockSize, startOffset, endOffset, query));
+        // One spare entry for the timeout that io_uring_wait_cqe_timeout()
+        // may need to queue on older kernels.
+        int const err = io_uring_queue_init(depth + 1, &reader->_ring, 0);
+        if (err < 0)
+        {
+            LOG4CXX_DEBUG(logger, "aio_input io_uring unavailable (" << strerror(-err) << "), falling back to read()");
+            return nullptr;
+        }
+        reader->_ringReady = true;
+        reader->_slots.resize(depth);
+        for (auto& slot : reader->_slots)
+        {
+            slot.buf = nullptr;
+            if (posix_memalign((void**) &slot.buf, getpagesize(), blockSize) != 0)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "File splitter cannot allocate memory";
+            }
+        }
+        for (size_t i = 0; i < depth; ++i)
+        {
+            reader->startSlot(i);
+        }
+        return std::unique_ptr<AioReader>(reader.release());
+    }
+
+    virtual ~UringReader()
+    {
+        if (_ringReady)
+        {
+            // The kernel may still be writing into our buffers; let every
+            // outstanding read land before giving the memory back.
+            while (_inFlight > 0)
+            {
+                io_uring_cqe* cqe = nullptr;
+                if (io_uring_wait_cqe(&_ring, &cqe) < 0)
+                {
+                    break;
+                }
+                io_uring_cqe_seen(&_ring, cqe);
+                --_inFlight;
+            }
+            io_uring_queue_exit(&_ring);
+        }
+        for (auto& slot : _slots)
+        {
+            free(slot.buf);
+        }
+    }
+
+    size_t read(char* buf, size_t count) override
+    {
+        size_t total = 0;
+        while (total < count)
+        {
+            waitForHead();
+            Slot& slot = _slots[_head];
+            if (slot.wanted == 0)
+            {
+                break;
+            }
+            size_t const n = std::min(slot.filled - _headPos, count - total);
+            memcpy(buf + total, slot.buf + _headPos, n);
+            total += n;
+            _headPos += n;
+            if (_headPos == slot.filled)
+            {
+                startSlot(_head);
+                _head = (_head + 1) % _slots.size();
+                _headPos = 0;
+            }
+        }
+        return total;
+    }
+};
+
+static size_t const URING_QUEUE_DEPTH = 4;
+#endif
+
+/**
+ * Maps a regular file into memory and serves blocks straight out of the
+ * mapping: no read() or select() per block, and for files already in the
+ * page cache the only copy made is the one into the outgoing chunk.
+ * The file must not be truncated while it is being loaded.
+ */
+class MmapReader : public AioReader
+{
+private:
+    char const* _base;
+    size_t      _mapSize;
+    size_t      _pos;
+    size_t      _end;
+
+    MmapReader(char const* base, size_t mapSize, size_t startOffset, size_t endOffset):
+        _base(base),
+        _mapSize(mapSize),
+        _pos(startOffset),
+        _end(endOffset)
+    {}
+
+public:
+    /**
+     * @return a reader for at most limit bytes of fd, starting at its current
+     *    offset, or nullptr if fd is not a regular file or cannot be mapped.
+     */
+    static std::unique_ptr<AioReader> create(int fd, uint64_t limit)
+    {
+        struct stat fdStat;
+        if (fstat(fd, &fdStat) != 0 || !S_ISREG(fdStat.st_mode) || fdStat.st_size == 0)
+        {
+            return nullptr;
+        }
+        off_t const startOffset = lseek(fd, 0, SEEK_CUR);
+        if (startOffset < 0)
+        {
+            return nullptr;
+        }
+        size_t const mapSize = fdStat.st_size;
+        void* base = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED)
+        {
+            LOG4CXX_DEBUG(logger, "aio_input cannot mmap input (" << strerror(errno) << "), falling back to read()");
+            return nullptr;
+        }
+        madvise(base, mapSize, MADV_SEQUENTIAL);
+        return std::unique_ptr<AioReader>(new MmapReader(static_cast<char const*>(base), mapSize, startOffset,
+                                                         rangeEnd(startOffset, limit, fdStat.st_size)));
+    }
+
+    virtual ~MmapReader()
+    {
+        munmap(const_cast<char*>(_base), _mapSize);
+    }
+
+    size_t read(char* buf, size_t count) override
+    {
+        size_t const n = _pos < _end ? std::min(count, _end - _pos) : 0;
+        memcpy(buf, _base + _pos, n);
+        _pos += n;
+        return n;
+    }
+};
+
+/**
+ * Reads a regular file with O_DIRECT so that a one-off bulk load does not
+ * push everybody else's working set out of the page cache. O_DIRECT wants
+ * the buffer, offset and length of every read aligned, so reads go through
+ * a page-aligned bounce buffer starting at the aligned offset at or below
+ * the next wanted byte; the unaligned head (after a header, or at the start
+ * of a parallel_read range) and the unaligned tail of the file are trimmed
+ * off when copying out.
+ */
+class DirectReader : public AioReader
+{
+private:
+    static size_t const ALIGNMENT = 4096;
+
+    int const       _fd;
+    char*           _bounce;
+    size_t const    _bounceSize;
+    off_t           _bounceStart;  // file offset of _bounce[0]
+    size_t          _bounceLen;    // valid bytes in _bounce
+    off_t           _pos;          // file offset of the next byte to hand out
+    off_t const     _end;
+    weak_ptr<Query> _query;
+
+    DirectReader(int fd, char* bounce, size_t bounceSize, off_t start, off_t end, weak_ptr<Query> query):
+        _fd(fd),
+        _bounce(bounce),
+        _bounceSize(bounceSize),
+        _bounceStart(0),
+        _bounceLen(0),
+        _pos(start),
+        _end(end),
+        _query(query)
+    {}
+
+    /**
+     * Refill the bounce buffer so that it covers _pos.
+     * @return false if the file ends before _pos.
+     */
+    bool refill()
+    {
+        Query::getValidQueryPtr(_query);
+        _bounceStart = _pos & ~((off_t) ALIGNMENT - 1);
+        ssize_t n;
+        do {
+            n = pread(_fd, _bounce, _bounceSize, _bounceStart);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0)
+        {
+            ostringstream oss;
+            oss << "aio_input() error reading from fd with O_DIRECT, errno="
+                << errno << " (" << strerror(errno) << ")";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+        }
+        _bounceLen = n;
+        return _bounceStart + (off_t) _bounceLen > _pos;
+    }
+
+public:
+    /**
+     * @return a reader for at most limit bytes of filePath, starting at
+     *    offset start, or nullptr if the file cannot be opened with O_DIRECT
+     *    (as on tmpfs, for example).
+     */
+    static std::unique_ptr<AioReader> create(std::string const& filePath,
+                                             off_t start,
+                                             uint64_t limit,
+                                             size_t blockSize,
+                                             weak_ptr<Query> query)
+    {
+        int fd = open(filePath.c_str(), O_RDONLY | O_DIRECT);
+        if (fd == -1)
+        {
+            LOG4CXX_DEBUG(logger, "aio_input cannot open input with O_DIRECT (" << strerror(errno) << "), falling back to buffered reads");
+            return nullptr;
+        }
+        struct stat fdStat;
+        if (fstat(fd, &fdStat) != 0 || !S_ISREG(fdStat.st_mode))
+        {
+            ::close(fd);
+            return nullptr;
+        }
+        // Room for a whole block plus the unaligned head in front of it.
+        size_t const bounceSize = (blockSize + 2 * ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        char* bounce = nullptr;
+        if (posix_memalign((void**) &bounce, ALIGNMENT, bounceSize) != 0)
+        {
+            ::close(fd);
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "File splitter cannot allocate memory";
+        }
+        return std::unique_ptr<AioReader>(new DirectReader(fd, bounce, bounceSize, start,
+                                                           rangeEnd(start, limit, fdStat.st_size), query));
+    }
+
+    virtual ~DirectReader()
+    {
+        free(_bounce);
+        ::close(_fd);
+    }
+
+    size_t read(char* buf, size_t count) override
+    {
+        size_t total = 0;
+        while (total < count && _pos < _end)
+        {
+            if (_pos >= _bounceStart + (off_t) _bounceLen && !refill())
+            {
+                break;
+            }
+            size_t const avail = std::min<off_t>(_bounceStart + _bounceLen, _end) - _pos;
+            size_t const n = std::min(avail, count - total);
+            memcpy(buf + total, _bounce + (_pos - _bounceStart), n);
+            total += n;
+            _pos += n;
+        }
+        return total;
+    }
+};
+
+/**
+ * Hands out some bytes that were already read from the input, such as the
+ * data that followed the header in the last block read by skipHeader, before
+ * those of the reader it wraps.
+ */
+class PrefixedReader : public AioReader
+{
+private:
+    vector<char>               _prefix;
+    size_t                     _prefixPos;
+    std::unique_ptr<AioReader> _inner;
+
+public:
+    PrefixedReader(vector<char>&& prefix, std::unique_ptr<AioReader>&& inner):
+        _prefix(std::move(prefix)),
+        _prefixPos(0),
+        _inner(std::move(inner))
+    {}
+
+    size_t read(char* buf, size_t count) override
+    {
+        size_t const n = std::min(count, _prefix.size() - _prefixPos);
+        memcpy(buf, _prefix.data() + _prefixPos, n);
+        _prefixPos += n;
+        return n == count ? n : n + _inner->read(buf + n, count - n);
+    }
+};
+
+/**
+ * Wrap reader so that it first hands out prefix, if there is one.
+ */
+static std::unique_ptr<AioReader> withPrefix(vector<char>&& prefix, std::unique_ptr<AioReader>&& reader)
+{
+    if (prefix.empty())
+    {
+        return std::move(reader);
+    }
+    return std::unique_ptr<AioReader>(new PrefixedReader(std::move(prefix), std::move(reader)));
+}
+
+/**
+ * Hands out the first bytes of the reader it wraps, up to a limit and then
+ * on to the end of the line the limit falls in, and nothing after that.
+ */
+class HeadReader : public AioReader
+{
+private:
+    std::unique_ptr<AioReader> _inner;
+    uint64_t                   _remaining;
+    char const                 _lineDelim;
+    bool                       _lineEnded;  // the last byte handed out was a line delimiter
+    bool                       _done;
+
+public:
+    HeadReader(std::unique_ptr<AioReader>&& inner, uint64_t limit, char lineDelim):
+        _inner(std::move(inner)),
+        _remaining(limit),
+        _lineDelim(lineDelim),
+        _lineEnded(false),
+        _done(false)
+    {}
+
+    size_t read(char* buf, size_t count) override
+    {
+        size_t total = 0;
+        if (!_done && _remaining > 0)
+        {
+            size_t const wanted = std::min<uint64_t>(count, _remaining);
+            total = _inner->read(buf, wanted);
+            _remaining -= total;
+            _done = (total < wanted);
+            if (total > 0)
+            {
+                _lineEnded = (buf[total - 1] == _lineDelim);
+            }
+        }
+        // Past the limit, finish the line a byte at a time: bytes read past
+        // its end could not be handed back, and the line is short next to
+        // the limit.
+        while (!_done && _remaining == 0 && total < count)
+        {
+            if (_lineEnded || _inner->read(buf + total, 1) == 0)
+            {
+                _done = true;
+                break;
+            }
+            _lineEnded = (buf[total++] == _lineDelim);
+        }
+        return total;
+    }
+};
+
+enum class Compression
+{
+    NONE,
+    GZIP,
+    ZSTD,
+    LZ4
+};
+
+/**
+ * Tell a compressed input from plain text by its magic bytes, which are
+ * read from the start of reader into magic.
+ */
+static Compression detectCompression(AioReader& reader, vector<char>& magic)
+{
+    magic.resize(4);
+    magic.resize(reader.read(magic.data(), magic.size()));
+    auto const m = reinterpret_cast<unsigned char const*>(magic.data());
+    if (magic.size() >= 2 && m[0] == 0x1f && m[1] == 0x8b)
+    {
+        return Compression::GZIP;
+    }
+    if (magic.size() == 4 && m[0] == 0x28 && m[1] == 0xb5 && m[2] == 0x2f && m[3] == 0xfd)
+    {
+        return Compression::ZSTD;
+    }
+    if (magic.size() == 4 && m[0] == 0x04 && m[1] == 0x22 && m[2] == 0x4d && m[3] == 0x18)
+    {
+        return Compression::LZ4;
+    }
+    return Compression::NONE;
+}
+
+/**
+ * One streaming decompression codec. Concatenated streams (multi-member
+ * gzip such as bgzip output, multi-frame zstd and lz4) decode as one.
+ */
+class Decompressor : public boost::noncopyable
+{
+public:
+    virtual ~Decompressor()
+    {}
+
+    /**
+     * Decode as much of [in, in+inLeft) into [out, out+outLeft) as fits,
+     * advancing the pointers and shrinking the counts by what was used.
+     * Output still held back from earlier input is written first, so a
+     * call with inLeft of 0 drains it.
+     */
+    virtual void decompress(char const*& in, size_t& inLeft, char*& out, size_t& outLeft) = 0;
+
+    /**
+     * @return true if the input seen so far ends in the middle of a stream.
+     */
+    virtual bool midStream() const = 0;
+};
+
+static void throwDecompressionError(char const* codec, char const* what)
+{
+    ostringstream oss;
+    oss << "aio_input() cannot decompress " << codec << " input (" << what << ")";
+    throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+}
+
+#ifdef USE_ZLIB
+class GzipDecompressor : public Decompressor
+{
+private:
+    z_stream _strm;
+    bool     _midStream;
+
+public:
+    GzipDecompressor():
+        _midStream(false)
+    {
+        memset(&_strm, 0, sizeof(_strm));
+        if (inflateInit2(&_strm, 16 + MAX_WBITS) != Z_OK)
+        {
+            throwDecompressionError("gzip", "cannot initialize zlib");
+        }
+    }
+
+    ~GzipDecompressor()
+    {
+        inflateEnd(&_strm);
+    }
+
+    void decompress(char const*& in, size_t& inLeft, char*& out, size_t& outLeft) override
+    {
+        while (outLeft > 0)
+        {
+            _strm.next_in = (Bytef*) in;
+            _strm.avail_in = (uInt) std::min<size_t>(inLeft, std::numeric_limits<uInt>::max());
+            _strm.next_out = (Bytef*) out;
+            _strm.avail_out = (uInt) std::min<size_t>(outLeft, std::numeric_limits<uInt>::max());
+            uInt const inBefore = _strm.avail_in;
+            uInt const outBefore = _strm.avail_out;
+            int const rc = inflate(&_strm, Z_NO_FLUSH);
+            in += inBefore - _strm.avail_in;
+            inLeft -= inBefore - _strm.avail_in;
+            out += outBefore - _strm.avail_out;
+            outLeft -= outBefore - _strm.avail_out;
+            if (rc == Z_STREAM_END)
+            {
+                // Another gzip member may follow.
+                inflateReset(&_strm);
+                _midStream = false;
+            }
+            else if (rc == Z_OK)
+            {
+                _midStream = true;
+                if (inBefore == _strm.avail_in && outBefore == _strm.avail_out)
+                {
+                    return;
+                }
+            }
+            else if (rc == Z_BUF_ERROR)
+            {
+                return;  // nothing left to decode or to flush
+            }
+            else
+            {
+                throwDecompressionError("gzip", _strm.msg ? _strm.msg : "corrupt data");
+            }
+        }
+    }
+
+    bool midStream() const override
+    {
+        return _midStream;
+    }
+};
+#endif
+
+#ifdef USE_ZSTD
+class ZstdDecompressor : public Decompressor
+{
+private:
+    ZSTD_DStream* _stream;
+    bool          _midStream;
+
+public:
+    ZstdDecompressor():
+        _stream(ZSTD_createDStream()),
+        _midStream(false)
+    {
+        if (_stream == nullptr || ZSTD_isError(ZSTD_initDStream(_stream)))
+        {
+            ZSTD_freeDStream(_stream);
+            throwDecompressionError("zstd", "cannot initialize zstd");
+        }
+    }
+
+    ~ZstdDecompressor()
+    {
+        ZSTD_freeDStream(_stream);
+    }
+
+    void decompress(char const*& in, size_t& inLeft, char*& out, size_t& outLeft) override
+    {
+        ZSTD_inBuffer input{in, inLeft, 0};
+        ZSTD_outBuffer output{out, outLeft, 0};
+        while (output.pos < output.size)
+        {
+            size_t const inPos = input.pos;
+            size_t const outPos = output.pos;
+            size_t const rc = ZSTD_decompressStream(_stream, &output, &input);
+            if (ZSTD_isError(rc))
+            {
+                throwDecompressionError("zstd", ZSTD_getErrorName(rc));
+            }
+            if (input.pos == inPos && output.pos == outPos)
+            {
+                break;  // nothing left to decode or to flush
+            }
+            _midStream = (rc != 0);
+        }
+        in += input.pos;
+        inLeft -= input.pos;
+        out += output.pos;
+        outLeft -= output.pos;
+    }
+
+    bool midStream() const override
+    {
+        return _midStream;
+    }
+};
+#endif
+
+#ifdef USE_LZ4
+class Lz4Decompressor : public Decompressor
+{
+private:
+    LZ4F_dctx* _ctx;
+    bool       _midStream;
+
+public:
+    Lz4Decompressor():
+        _ctx(nullptr),
+        _midStream(false)
+    {
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&_ctx, LZ4F_VERSION)))
+        {
+            throwDecompressionError("lz4", "cannot initialize lz4");
+        }
+    }
+
+    ~Lz4Decompressor()
+    {
+        LZ4F_freeDecompressionContext(_ctx);
+    }
+
+    void decompress(char const*& in, size_t& inLeft, char*& out, size_t& outLeft) override
+    {
+        while (outLeft > 0)
+        {
+            size_t inUsed = inLeft;
+            size_t outUsed = outLeft;
+            size_t const rc = LZ4F_decompress(_ctx, out, &outUsed, in, &inUsed, nullptr);
+            if (LZ4F_isError(rc))
+            {
+                throwDecompressionError("lz4", LZ4F_getErrorName(rc));
+            }
+            if (inUsed == 0 && outUsed == 0)
+            {
+                return;  // nothing left to decode or to flush
+            }
+            // A finished frame resets the context for the next one.
+            _midStream = (rc != 0);
+            in += inUsed;
+            inLeft -= inUsed;
+            out += outUsed;
+            outLeft -= outUsed;
+        }
+    }
+
+    bool midStream() const override
+    {
+        return _midStream;
+    }
+};
+#endif
+
+/**
+ * Decompresses the bytes of another reader on a dedicated thread, which
+ * stays up to a few blocks ahead of the consumer so that decompression
+ * overlaps with redistribution and parsing.
+ */
+class DecompressingReader : public AioReader
+{
+private:
+    static size_t const BLOCK_SIZE = 1024 * 1024;
+    static size_t const QUEUE_DEPTH = 4;
+
+    std::unique_ptr<AioReader>    _source;
+    std::unique_ptr<Decompressor> _codec;
+    char const*                   _codecName;
+    weak_ptr<Query>               _query;
+    std::mutex                    _mutex;
+    std::condition_variable       _cond;
+    std::deque<vector<char> >     _blocks;   // decompressed, not yet handed out
+    size_t                        _headPos;  // bytes of _blocks.front() handed out
+    bool                          _done;     // the thread will add no more blocks
+    bool                          _stopping; // the consumer has gone away
+    std::exception_ptr            _error;
+    std::thread                   _thread;
+
+    DecompressingReader(std::unique_ptr<AioReader>&& source,
+                        std::unique_ptr<Decompressor>&& codec,
+                        char const* codecName,
+                        weak_ptr<Query> query):
+        _source(std::move(source)),
+        _codec(std::move(codec)),
+        _codecName(codecName),
+        _query(query),
+        _headPos(0),
+        _done(false),
+        _stopping(false)
+    {
+        _thread = std::thread(&DecompressingReader::run, this);
+    }
+
+    /**
+     * Queue a full block, waiting for room.
+     * @return false if the consumer has gone away.
+     */
+    bool push(vector<char>&& block)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this] { return _stopping || _blocks.size() < QUEUE_DEPTH; });
+        if (_stopping)
+        {
+            return false;
+        }
+        _blocks.push_back(std::move(block));
+        _cond.notify_all();
+        return true;
+    }
+
+    void run()
+    {
+        try
+        {
+            vector<char> input(BLOCK_SIZE);
+            vector<char> output(BLOCK_SIZE);
+            size_t outUsed = 0;
+            bool eof = false;
+            while (!eof)
+            {
+                size_t const inUsed = _source->read(input.data(), input.size());
+                eof = (inUsed < input.size());
+                char const* in = input.data();
+                size_t inLeft = inUsed;
+                bool outFull = false;
+                // Once the input is used up, go on while the output keeps
+                // filling: the codec may still hold some of it back.
+                do
+                {
+                    char* out = output.data() + outUsed;
+                    size_t outLeft = output.size() - outUsed;
+                    size_t const inBefore = inLeft;
+                    _codec->decompress(in, inLeft, out, outLeft);
+                    if (inLeft > 0 && inLeft == inBefore && outLeft == output.size() - outUsed)
+                    {
+                        // Room for output and no pending output, yet the
+                        // input cannot be decoded.
+                        throwDecompressionError(_codecName, "no progress on corrupt data");
+                    }
+                    outUsed = output.size() - outLeft;
+                    outFull = (outLeft == 0);
+                    if (outFull)
+                    {
+                        if (!push(std::move(output)))
+                        {
+                            return;
+                        }
+                        output.assign(BLOCK_SIZE, 0);
+                        outUsed = 0;
+                    }
+                } while (inLeft > 0 || outFull);
+            }
+            if (_codec->midStream())
+            {
+                throwDecompressionError(_codecName, "input is truncated");
+            }
+            if (outUsed > 0)
+            {
+                output.resize(outUsed);
+                push(std::move(output));
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _done = true;
+        _cond.notify_all();
+    }
+
+public:
+    /**
+     * @return a reader that decompresses source, or throws if this build
+     *    lacks support for the given compression.
+     */
+    static std::unique_ptr<AioReader> create(Compression compression,
+                                             std::unique_ptr<AioReader>&& source,
+                                             weak_ptr<Query> query)
+    {
+        std::unique_ptr<Decompressor> codec;
+        char const* name = "";
+        switch (compression)
+        {
+        case Compression::GZIP:
+            name = "gzip";
+#ifdef USE_ZLIB
+            codec.reset(new GzipDecompressor());
+#endif
+            break;
+        case Compression::ZSTD:
+            name = "zstd";
+#ifdef USE_ZSTD
+            codec.reset(new ZstdDecompressor());
+#endif
+            break;
+        case Compression::LZ4:
+            name = "lz4";
+#ifdef USE_LZ4
+            codec.reset(new Lz4Decompressor());
+#endif
+            break;
+        case Compression::NONE:
+            return std::move(source);
+        }
+        if (!codec)
+        {
+            ostringstream oss;
+            oss << "aio_input() input is " << name << "-compressed but this build has no " << name << " support";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+        }
+        return std::unique_ptr<AioReader>(new DecompressingReader(std::move(source), std::move(codec), name, query));
+    }
+
+    ~DecompressingReader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+            _cond.notify_all();
+        }
+        // The thread is either waiting for room, which _stopping ends, or in
+        // a read of the source, which returns or notices a cancelled query.
+        _thread.join();
+    }
+
+    size_t read(char* buf, size_t count) override
+    {
+        size_t total = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (total < count)
+        {
+            if (_blocks.empty())
+            {
+                if (_error)
+                {
+                    std::rethrow_exception(_error);
+                }
+                if (_done)
+                {
+                    break;
+                }
+                if (!_cond.wait_for(lock, std::chrono::seconds(1), [this] { return _done || !_blocks.empty(); }))
+                {
+                    // Nothing decompressed yet; make sure the query is still alive.
+                    Query::getValidQueryPtr(_query);
+                }
+                continue;
+            }
+            vector<char>& head = _blocks.front();
+            size_t const n = std::min(count - total, head.size() - _headPos);
+            memcpy(buf + total, head.data() + _headPos, n);
+            total += n;
+            _headPos += n;
+            if (_headPos == head.size())
+            {
+                _blocks.pop_front();
+                _headPos = 0;
+                _cond.notify_all();
+            }
+        }
+        return total;
+    }
+};
+
+/**
+ * Pick the reader for fd: the mapping if mmap:true was requested, O_DIRECT
+ * if direct_io:true was, io_uring for regular files when available, plain
+ * select()/read() otherwise. Readers that cannot handle fd decline and the
+ * next one is tried.
+ *
+ * @param limit The most bytes to read, starting at fd's current offset.
+ */
+static std::unique_ptr<AioReader> makeReader(int fd,
+                                             string const& filePath,
+                                             AioInputSettings const& settings,
+                                             uint64_t limit,
+                                             weak_ptr<Query> query)
+{
+    std::unique_ptr<AioReader> reader;
+    if (settings.getMmap())
+    {
+        reader = MmapReader::create(fd, limit);
+    }
+    if (!reader && settings.getDirectIo())
+    {
+        off_t const start = lseek(fd, 0, SEEK_CUR);
+        if (start >= 0)
+        {
+            reader = DirectReader::create(filePath, start, limit, settings.getBlockSize(), query);
+        }
+    }
+#ifdef USE_IO_URING
+    if (!reader)
+    {
+        reader = UringReader::create(fd, settings.getBlockSize(), URING_QUEUE_DEPTH, limit, query);
+    }
+#endif
+    if (!reader)
+    {
+        reader.reset(new FdReader(fd, limit, query));
+    }
+    return reader;
+}
+
+/**
+ * Per-instance counters of where an aio_input spends its time, logged at INFO
+ * when the operator finishes. The read counters are written by whichever
+ * thread fills the blocks, hence atomic.
+ */
+struct AioInputStats
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::atomic<uint64_t> bytesRead{0};
+    std::atomic<uint64_t> readNanos{0};  // waiting on the reader for input
+    uint64_t redistributeNanos{0};       // sending blocks out; includes reading them
+    uint64_t supplementNanos{0};         // cutting and exchanging the ragged line ends
+    uint64_t parseNanos{0};
+    uint64_t lines{0};
+    uint64_t errorLines{0};
+    uint64_t skippedLines{0};
+    uint64_t filteredLines{0};
+    uint64_t sampledOutLines{0};
+
+    static uint64_t nanosSince(Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    void log(InstanceID instance) const
+    {
+        LOG4CXX_INFO(logger, "aio_input instance " << instance
+                     << " read " << bytesRead << " bytes in " << readNanos / 1000000 << " ms"
+                     << ", redistribute " << redistributeNanos / 1000000 << " ms"
+                     << ", supplement " << supplementNanos / 1000000 << " ms"
+                     << ", parse " << parseNanos / 1000000 << " ms"
+                     << ", " << lines << " lines, " << errorLines << " with errors, "
+                     << skippedLines << " skipped, " << filteredLines << " filtered out, "
+                     << sampledOutLines << " sampled out");
+    }
+};
+
+/**
+ * The line index that write_index leaves next to an input file, at its path
+ * with ".aioidx" appended, and that use_index reads back. There is an entry
+ * for every block the file was cut into: the offset where the block starts,
+ * always the start of a line, the number of lines before it, and the fewest
+ * and most fields on any of its lines. A last entry gives the offset where
+ * the data ends and the number of lines in all. The header ties the index
+ * to the size and modification time of the file and to the delimiters and
+ * buffer_size it was cut with.
+ */
+class LineIndex
+{
+public:
+    struct Entry
+    {
+        uint64_t offset;
+        uint64_t firstLine;
+        uint32_t minFields;
+        uint32_t maxFields;
+    };
+
+private:
+    struct Header
+    {
+        char     magic[8];
+        uint64_t fileSize;
+        int64_t  mtimeSec;
+        int64_t  mtimeNsec;
+        uint64_t blockSize;
+        uint64_t numEntries;
+        char     lineDelim;
+        char     attDelim;
+        char     quote;
+        char     pad[5];
+    };
+
+    static constexpr char const* MAGIC = "AIOIDX01";
+
+    Header        _header;
+    vector<Entry> _entries;
+
+    LineIndex()
+    {
+        memset(&_header, 0, sizeof(_header));
+    }
+
+    static void fail(string const& what, string const& path)
+    {
+        ostringstream oss;
+        oss << "aio_input() " << what << " '" << path << "'";
+        if (errno)
+        {
+            oss << " (" << strerror(errno) << ")";
+        }
+        throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+    }
+
+    // The header fields that describe the file open at fd, as it is now.
+    static Header describe(int fd, AioInputSettings const& settings)
+    {
+        struct stat fdStat;
+        if (fstat(fd, &fdStat) != 0)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "aio_input() cannot stat the input file";
+        }
+        Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.fileSize = fdStat.st_size;
+        header.mtimeSec = fdStat.st_mtim.tv_sec;
+        header.mtimeNsec = fdStat.st_mtim.tv_nsec;
+        header.blockSize = settings.getBlockSize();
+        header.lineDelim = settings.getLineDelimiter();
+        header.attDelim = settings.getAttributeDelimiter();
+        header.quote = settings.getQuote();
+        return header;
+    }
+
+public:
+    /**
+     * @return the path of the index of the input file at filePath.
+     */
+    static string pathFor(string const& filePath)
+    {
+        return filePath + ".aioidx";
+    }
+
+    /**
+     * Start an empty index of the file open at fd.
+     */
+    LineIndex(int fd, AioInputSettings const& settings):
+        _header(describe(fd, settings))
+    {}
+
+    void add(Entry const& entry)
+    {
+        _entries.push_back(entry);
+    }
+
+    /**
+     * @return the entries, the last of which marks the end of the data.
+     */
+    vector<Entry> const& entries() const
+    {
+        return _entries;
+    }
+
+    /**
+     * End the index at dataEnd, after totalLines lines, and write it to path.
+     * It goes to a temporary file first, renamed over path once complete,
+     * so that an index is never seen half written.
+     */
+    void write(string const& path, uint64_t dataEnd, uint64_t totalLines)
+    {
+        _entries.push_back(Entry{dataEnd, totalLines, 0, 0});
+        _header.numEntries = _entries.size();
+        string const tmpPath = path + ".tmp";
+        errno = 0;
+        int const fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1)
+        {
+            fail("cannot create line index", tmpPath);
+        }
+        bool ok = ::write(fd, &_header, sizeof(_header)) == (ssize_t) sizeof(_header);
+        size_t const entryBytes = _entries.size() * sizeof(Entry);
+        for (size_t done = 0; ok && done < entryBytes; )
+        {
+            ssize_t const n = ::write(fd, reinterpret_cast<char const*>(_entries.data()) + done, entryBytes - done);
+            ok = n > 0;
+            done += ok ? n : 0;
+        }
+        ok = (::close(fd) == 0) && ok;
+        if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0)
+        {
+            unlink(tmpPath.c_str());
+            fail("cannot write line index", path);
+        }
+        LOG4CXX_DEBUG(logger, "aio_input wrote line index " << path << " of " << _entries.size() - 1 << " blocks");
+    }
+
+    /**
+     * Read the index at path of the file open at fd.
+     *
+     * @throw if there is no index, or it is damaged, or it does not match
+     *    the file as it is now, or the delimiters, or blocks of buffer_size.
+     */
+    static LineIndex read(string const& path, int fd, AioInputSettings const& settings)
+    {
+        LineIndex index;
+        errno = 0;
+        int const indexFd = ::open(path.c_str(), O_RDONLY);
+        if (indexFd == -1)
+        {
+            fail("cannot open line index", path);
+        }
+        struct stat indexStat;
+        bool ok = fstat(indexFd, &indexStat) == 0
+            && (size_t) indexStat.st_size >= sizeof(Header)
+            && pread(indexFd, &index._header, sizeof(Header), 0) == (ssize_t) sizeof(Header)
+            && index._header.numEntries > 0
+            && (size_t) indexStat.st_size == sizeof(Header) + index._header.numEntries * sizeof(Entry);
+        if (ok)
+        {
+            index._entries.resize(index._header.numEntries);
+            size_t const entryBytes = index._entries.size() * sizeof(Entry);
+            ok = pread(indexFd, index._entries.data(), entryBytes, sizeof(Header)) == (ssize_t) entryBytes;
+        }
+        ::close(indexFd);
+        errno = 0;
+        if (!ok || memcmp(index._header.magic, MAGIC, sizeof(index._header.magic)) != 0)
+        {
+            fail("found a damaged line index at", path);
+        }
+        Header const now = describe(fd, settings);
+        if (index._header.fileSize != now.fileSize || index._header.mtimeSec != now.mtimeSec
+            || index._header.mtimeNsec != now.mtimeNsec)
+        {
+            fail("input file has changed since it was indexed; write_index again to replace", path);
+        }
+        if (index._header.lineDelim != now.lineDelim || index._header.attDelim != now.attDelim
+            || index._header.quote != now.quote)
+        {
+            fail("input file was indexed with other delimiters or format; see", path);
+        }
+        if (index._header.blockSize > now.blockSize)
+        {
+            fail("input file was indexed with a larger buffer_size; see", path);
+        }
+        return index;
+    }
+};
+
+/**
+ * How far a resumable load has got on one instance: the number of the next
+ * block it will read, and for every file it reads, the offset up to which
+ * the file's data has been loaded. It is kept in a small text file: a line
+ * with the number of instances and the next block, then one line per file
+ * with the offset and the path.
+ *
+ * A run's checkpoint is written to a temporary file beside it, created
+ * before any data is read and filled in once all of the input has been
+ * read, so that a checkpoint that cannot be written fails the query. Only
+ * the rename over the old checkpoint is left for after the commit. Should
+ * even that fail, the filled temporary file is left behind, and the next
+ * run refuses to start until someone decides which of the two stands.
+ */
+class LoadCheckpoint
+{
+private:
+    string                    _path;
+    string                    _tmpPath;
+    int                       _tmpFd;
+    uint64_t                  _numInstances;
+    uint64_t                  _nextBlock;
+    bool                      _found;      // read from an earlier run
+    bool                      _complete;   // all of this run's input has been read, and written to _tmpPath
+    std::map<string, uint64_t> _offsets;
+
+    void fail(string const& what, string const& path) const
+    {
+        ostringstream oss;
+        oss << "aio_input() cannot " << what << " checkpoint " << path << ": " << strerror(errno);
+        throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+    }
+
+public:
+    /**
+     * @return the path of instance's checkpoint, for the resume path given.
+     */
+    static string pathFor(string const& path, InstanceID instance)
+    {
+        ostringstream out;
+        out << path << "." << instance;
+        return out.str();
+    }
+
+    /**
+     * Read the checkpoint at path, left by an earlier run on numInstances
+     * instances; if there is none, start one for a first run. Either way,
+     * create the temporary file this run's checkpoint goes to.
+     */
+    LoadCheckpoint(string const& path, uint64_t numInstances, uint64_t firstBlock):
+        _path(path),
+        _tmpPath(path + ".tmp"),
+        _tmpFd(-1),
+        _numInstances(numInstances),
+        _nextBlock(firstBlock),
+        _found(false),
+        _complete(false)
+    {
+        struct stat tmpStat;
+        if (::stat(_tmpPath.c_str(), &tmpStat) == 0 && tmpStat.st_size > 0)
+        {
+            // An empty one is left by a run that failed before its input
+            // was read; a filled one, by a run that may have committed.
+            ostringstream oss;
+            oss << "aio_input() cannot resume: " << _tmpPath << " is left by a run that may have committed without saving its checkpoint;"
+                << " if its data was stored, rename it to " << path << ", otherwise remove it";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+        }
+        std::ifstream in(path);
+        if (in)
+        {
+            uint64_t checkpointInstances = 0;
+            bool ok = static_cast<bool>(in >> checkpointInstances >> _nextBlock);
+            uint64_t offset;
+            string file;
+            while (ok && in >> offset && std::getline(in >> std::ws, file))
+            {
+                _offsets[file] = offset;
+            }
+            if (!ok || in.bad() || !in.eof())
+            {
+                ostringstream oss;
+                oss << "aio_input() cannot read checkpoint " << path;
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+            }
+            if (checkpointInstances != numInstances)
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "aio_input() cannot resume on a different number of instances";
+            }
+            _found = true;
+            LOG4CXX_DEBUG(logger, "aio_input resuming from " << path << " at block " << _nextBlock);
+        }
+        else
+        {
+            LOG4CXX_DEBUG(logger, "aio_input found no checkpoint " << path << ", starting from the beginning");
+        }
+        _tmpFd = ::open(_tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (_tmpFd < 0)
+        {
+            fail("create", _tmpPath);
+        }
+    }
+
+    ~LoadCheckpoint()
+    {
+        if (_tmpFd >= 0)
+        {
+            ::close(_tmpFd);
+        }
+    }
+
+    uint64_t getNextBlock() const
+    {
+        return _nextBlock;
+    }
+
+    /**
+     * @return the offset in file at which to carry on loading, or dataStart
+     *    if the load has yet to start on it.
+     * @throw if an earlier run did not read file, which would load it again
+     *    or, if it was read by another instance then, twice.
+     */
+    uint64_t getOffset(string const& file, uint64_t dataStart) const
+    {
+        auto const found = _offsets.find(file);
+        if (found != _offsets.end())
+        {
+            return std::max(found->second, dataStart);
+        }
+        if (_found)
+        {
+            ostringstream oss;
+            oss << "aio_input() cannot resume: " << file << " was not read by this instance before";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+        }
+        return dataStart;
+    }
+
+    void setOffset(string const& file, uint64_t offset)
+    {
+        _offsets[file] = offset;
+    }
+
+    /**
+     * Note that all of the input has been read, into blocks numbered up to
+     * nextBlock, and write the checkpoint that says so to the temporary
+     * file, ready for the commit.
+     * @throw if the checkpoint cannot be written.
+     */
+    void complete(uint64_t nextBlock)
+    {
+        _nextBlock = nextBlock;
+        ostringstream out;
+        out << _numInstances << " " << _nextBlock << "\n";
+        for (auto const& entry : _offsets)
+        {
+            out << entry.second << " " << entry.first << "\n";
+        }
+        string const text = out.str();
+        size_t written = 0;
+        while (written < text.size())
+        {
+            ssize_t const n = ::pwrite(_tmpFd, text.data() + written, text.size() - written, written);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                fail("write", _tmpPath);
+            }
+            written += n;
+        }
+        if (::fsync(_tmpFd) != 0)
+        {
+            fail("write", _tmpPath);
+        }
+        _complete = true;
+    }
+
+    /**
+     * Once the query has finished, make this run's checkpoint the one the
+     * next run starts from, if the query committed having read all of the
+     * input; otherwise keep the last run's. Nothing can fail the query by
+     * now, so a checkpoint that cannot be renamed into place is logged and
+     * its temporary file left for the next run to refuse.
+     */
+    void finish(bool committed)
+    {
+        if (!committed || !_complete)
+        {
+            ::unlink(_tmpPath.c_str());
+            return;
+        }
+        if (::rename(_tmpPath.c_str(), _path.c_str()) != 0)
+        {
+            LOG4CXX_ERROR(logger, "aio_input loaded its input but could not rename " << _tmpPath << " to " << _path
+                          << ": " << strerror(errno) << "; the next run will not start until one of them is removed");
+            return;
+        }
+        LOG4CXX_INFO(logger, "aio_input saved checkpoint " << _path << " at block " << _nextBlock);
+    }
+};
+
+class BinFileSplitArray : public SinglePassArray
+{
+private:
+    typedef SinglePassArray super;
+
+    /**
+     * A chunk holding one block of the file as a single string value, with
+     * pointers to the string's bytes and to its length.
+     */
+    struct Block
+    {
+        MemChunk  chunk;
+        char*     data;
+        uint32_t* size;
+
+        Block():
+            chunk(SCIDB_CODE_LOC),
+            data(nullptr),
+            size(nullptr)
+        {}
+    };
+
+    size_t _rowIndex;
+    Address _chunkAddress;
+    weak_ptr<Query> _query;
+    size_t const _fileBlockSize;
+    size_t const _chunkOverheadSize;
+    bool         _endOfFile;
+    int          _inputFile;
+    std::unique_ptr<AioReader> _reader;
+    size_t const _nInstances;
+    Coordinate   _firstBlock;
+    shared_ptr<AioInputSettings> const _settings;
+    vector<string> const& _inputFiles;
+    size_t       _nextFile;
+    bool         _midLine;      // the current file's data so far ends inside a line
+    bool const   _lineAligned;
+    vector<char> _carry;        // for line_aligned, the partial line that starts the next block
+    bool         _inputEnded;   // fillBlock has delivered all of the input
+    shared_ptr<AioInputStats> const _stats;
+    size_t const _readAhead;
+    vector<std::unique_ptr<Block> > _blocks;  // _readAhead + 1 of them, used as a ring
+    size_t       _current;                    // the block last returned by getChunk
+    std::unique_ptr<LineIndex> _index;        // for write_index, of the current file
+    string       _indexPath;
+    uint64_t     _filePos;      // offset in the current file of the next byte to read
+    uint64_t     _fileLines;    // lines of the current file put in blocks so far
+    bool         _openNext;     // for write_index, the next block starts the next file
+    vector<uint64_t> _cuts;     // for use_index, the sizes of this instance's blocks
+    size_t       _nextCut;
+    shared_ptr<LoadCheckpoint> _checkpoint;  // for resume
+    string       _currentFile;
+    uint64_t     _blocksFilled;
+
+    // Read-ahead state shared with the _prefetcher thread, under _mutex
+    std::mutex              _mutex;
+    std::condition_variable _cond;
+    vector<size_t>          _blockBytes;  // bytes filled into each block
+    size_t                  _produced;    // blocks filled so far
+    size_t                  _consumed;    // blocks handed to moveNext so far
+    bool                    _producerDone;
+    bool                    _stopping;
+    std::exception_ptr      _error;
+    std::thread             _prefetcher;
+
+public:
+    BinFileSplitArray(ArrayDesc const& schema,
+                      shared_ptr<Query>& query,
+                      shared_ptr<AioInputSettings> settings,
+                      shared_ptr<AioInputStats> stats):
+        super(schema),
+        _rowIndex(0),
+        _chunkAddress(0, Coordinates(3,0)),
+        _query(query),
+        _fileBlockSize(settings->getBlockSize()),
+        _chunkOverheadSize( getChunkOverheadSize() ),
+        _endOfFile(false),
+        _inputFile(-1),  // invalid FD
+        _nInstances(query->getInstancesCount()),
+        _firstBlock(query->getInstanceID()),
+        _settings(settings),
+        _inputFiles(settings->getInputFiles()),
+        _nextFile(0),
+        _midLine(false),
+        _lineAligned(settings->getLineAligned()),
+        _inputEnded(false),
+        _stats(stats),
+        _readAhead(settings->getReadAhead()),
+        _current(0),
+        _filePos(0),
+        _fileLines(0),
+        _openNext(false),
+        _nextCut(0),
+        _blocksFilled(0),
+        _blockBytes(_readAhead + 1, 0),
+        _produced(0),
+        _consumed(0),
+        _producerDone(false),
+        _stopping(false)
+    {
+        super::setEnforceHorizontalIteration(true);
+        _chunkAddress.coords[2] = query->getInstanceID();
+        for (size_t i = 0; i <= _readAhead; ++i)
+        {
+            _blocks.push_back(std::unique_ptr<Block>(new Block()));
+            initBlock(*_blocks.back());
+        }
+        if (!settings->getResume().empty())
+        {
+            startCheckpoint(query);
+        }
+        openNextFile(query);
+        if (_readAhead > 0)
+        {
+            _prefetcher = std::thread(&BinFileSplitArray::prefetch, this);
+        }
+    }
+
+    /**
+     * For resume, carry on from this instance's checkpoint: block numbers
+     * continue from where the last run left them, and each file from its
+     * offset. The progress of this run is saved in the checkpoint only once
+     * the query commits; until then the last run's checkpoint stands. Its
+     * temporary file is created here, before any data is read, so that a
+     * checkpoint that cannot be written fails the query before it loads
+     * anything.
+     */
+    void startCheckpoint(shared_ptr<Query>& query)
+    {
+        string const path = LoadCheckpoint::pathFor(_settings->getResume(), query->getInstanceID());
+        shared_ptr<LoadCheckpoint> checkpoint = std::make_shared<LoadCheckpoint>(path, _nInstances, _firstBlock);
+        _checkpoint = checkpoint;
+        _firstBlock = checkpoint->getNextBlock();
+        query->pushFinalizer([checkpoint](shared_ptr<Query> const& finished) {
+            checkpoint->finish(finished->wasCommitted());
+        });
+    }
+
+    void initBlock(Block& block)
+    {
+        try
+        {
+            block.chunk.allocate(_chunkOverheadSize + _fileBlockSize,
+                                 AllocType::chunk, SCIDB_CODE_LOC);
+        }
+        catch(...)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "File splitter cannot allocate memory";
+        }
+        char* bufPointer = (char*) block.chunk.getWriteData();
+        RLEPayload::PayloadHeader* hdr = (RLEPayload::PayloadHeader*) bufPointer;
+        hdr->_magic = RLE_PAYLOAD_MAGIC;
+        hdr->_nSegs = 1;
+        hdr->_elemSize = 0;
+        hdr->_dataSize = _fileBlockSize + 5 + sizeof(varpart_offset_t);
+        hdr->_varOffs = sizeof(varpart_offset_t);
+        hdr->_isBoolean = 0;
+        PayloadSegment* seg = (PayloadSegment*) (hdr+1);
+        *seg =  PayloadSegment(0,0,false,false);
+        ++seg;
+        *seg =  PayloadSegment(1,0,false,false);
+        varpart_offset_t* vp =  (varpart_offset_t*) (seg+1);
+        *vp = 0;
+        uint8_t* sizeFlag = (uint8_t*) (vp+1);
+        *sizeFlag =0;
+        block.size = (uint32_t*) (sizeFlag + 1);
+        *block.size = (uint32_t) _fileBlockSize;
+        block.data = (char*) (block.size+1);
+    }
+
+    /**
+     * Close the current input file, if any, and set up _reader for the data
+     * of the next one in _inputFiles: past its header, decompressed if need
+     * be, and cut down to this instance's range for parallel_read.
+     */
+    void openNextFile(shared_ptr<Query> const& query)
+    {
+        closeInput();
+        shared_ptr<AioInputSettings> const& settings = _settings;
+        string const& filePath = _inputFiles[_nextFile++];
+        _currentFile = filePath;
+        _midLine = false;
+        _inputFile = openFile(filePath, query->getInstanceID());
+        bool const seekable = (lseek(_inputFile, 0, SEEK_CUR) == 0);
+        bool const hasHeader = settings->getHeader() > 0 || !settings->getHeaderPrefix().empty();
+        if (settings->getParallelRead() && !seekable)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "parallel_read requires a regular file";
+        }
+        // A FIFO must not be read again once it has reported its end, so an
+        // input that cannot seek back is read through this one reader
+        // throughout; whatever was examined up front is handed out again
+        // ahead of the rest.
+        std::unique_ptr<AioReader> source(new FdReader(_inputFile, READ_TO_END, query));
+        vector<char> pending;
+        Compression const compression = detectCompression(*source, pending);
+        if (seekable)
+        {
+            lseek(_inputFile, 0, SEEK_SET);
+            pending.clear();
+        }
+        if ((settings->getWriteIndex() || _checkpoint) && (compression != Compression::NONE || !seekable))
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "write_index and resume need uncompressed regular files";
+        }
+        if (compression != Compression::NONE)
+        {
+            if (settings->getParallelRead())
+            {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "parallel_read cannot be used with compressed input";
+            }
+            if (seekable)
+            {
+                source = makeReader(_inputFile, filePath, *settings, READ_TO_END, query);
+            }
+            _reader = DecompressingReader::create(compression, withPrefix(std::move(pending), std::move(source)), query);
+            if (hasHeader)
+            {
+                skipHeader(*_reader, settings->getHeader(), settings->getHeaderPrefix(),
+                           settings->getLineDelimiter(), pending);
+                _reader = withPrefix(std::move(pending), std::move(_reader));
+            }
+        }
+        else if (!seekable)
+        {
+            _reader = withPrefix(std::move(pending), std::move(source));
+            if (hasHeader)
+            {
+                skipHeader(*_reader, settings->getHeader(), settings->getHeaderPrefix(),
+                           settings->getLineDelimiter(), pending);
+                _reader = withPrefix(std::move(pending), std::move(_reader));
+            }
+        }
+        else
+        {
+            off_t dataStart = 0;
+            if (hasHeader)
+            {
+                // Regular files are simply read again from just past the header.
+                dataStart = skipHeader(*source, settings->getHeader(), settings->getHeaderPrefix(),
+                                       settings->getLineDelimiter(), pending);
+                lseek(_inputFile, dataStart, SEEK_SET);
+            }
+            source.reset();
+            if (_checkpoint)
+            {
+                off_t const resumeAt = _checkpoint->getOffset(filePath, dataStart);
+                struct stat fdStat;
+                if (fstat(_inputFile, &fdStat) != 0 || fdStat.st_size < resumeAt)
+                {
+                    throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "aio_input() input file is shorter than its checkpoint says";
+                }
+                if (resumeAt != dataStart && lseek(_inputFile, resumeAt, SEEK_SET) != resumeAt)
+                {
+                    ostringstream oss;
+                    oss << "aio_input() cannot seek in input file (" << strerror(errno) << ")";
+                    throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+                }
+                dataStart = resumeAt;
+            }
+            _filePos = dataStart;
+            _fileLines = 0;
+            if (settings->getWriteIndex())
+            {
+                _index.reset(new LineIndex(_inputFile, *settings));
+                _indexPath = LineIndex::pathFor(filePath);
+            }
+            uint64_t readLimit = READ_TO_END;
+            if (settings->getParallelRead())
+            {
+                readLimit = settings->getUseIndex() ? seekToIndexedRange(query, filePath) : seekToRange(query);
+            }
+            _reader = makeReader(_inputFile, filePath, *settings, readLimit, query);
+        }
+        if (settings->getMaxBytes() > 0)
+        {
+            _reader.reset(new HeadReader(std::move(_reader), settings->getMaxBytes(), settings->getLineDelimiter()));
+        }
+    }
+
+    /**
+     * For parallel_read, position the input at the start of this instance's
+     * share of the file and return the length of that share.
+     *
+     * The data after the header is cut into blocks of _fileBlockSize and every
+     * instance takes a contiguous run of them. Blocks are numbered as if
+     * instance 0 had read the whole file by itself, so makeSupplement and
+     * exchangeLastBlocks stitch the ragged lines between the runs back
+     * together exactly as they do between the blocks of a single reader.
+     */
+    uint64_t seekToRange(shared_ptr<Query> const& query)
+    {
+        struct stat fdStat;
+        if (fstat(_inputFile, &fdStat) != 0 || !S_ISREG(fdStat.st_mode))
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "parallel_read requires a regular file";
+        }
+        off_t const dataStart = lseek(_inputFile, 0, SEEK_CUR);
+        uint64_t const dataSize = fdStat.st_size > dataStart ? fdStat.st_size - dataStart : 0;
+        uint64_t const numBlocks = (dataSize + _fileBlockSize - 1) / _fileBlockSize;
+        uint64_t const myId = query->getInstanceID();
+        uint64_t const firstBlock = numBlocks * myId / _nInstances;
+        uint64_t const endBlock = numBlocks * (myId + 1) / _nInstances;
+        _firstBlock = firstBlock;
+        _chunkAddress.coords[2] = 0;
+        if (firstBlock == endBlock)
+        {
+            return 0;
+        }
+        if (lseek(_inputFile, dataStart + firstBlock * _fileBlockSize, SEEK_SET) < 0)
+        {
+            ostringstream oss;
+            oss << "aio_input() cannot seek in input file (" << strerror(errno) << ")";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+        }
+        LOG4CXX_DEBUG(logger, "aio_input parallel_read blocks " << firstBlock << " to " << endBlock << " of " << numBlocks);
+        return std::min(dataSize, endBlock * _fileBlockSize) - firstBlock * _fileBlockSize;
+    }
+
+    /**
+     * For use_index, the same as seekToRange but along the file's line
+     * index: every instance takes a contiguous run of the index's blocks and
+     * reads each of them as one block of its own, so that all blocks are
+     * whole lines and are numbered as they were when the index was written.
+     */
+    uint64_t seekToIndexedRange(shared_ptr<Query> const& query, string const& filePath)
+    {
+        LineIndex const index = LineIndex::read(LineIndex::pathFor(filePath), _inputFile, *_settings);
+        vector<LineIndex::Entry> const& entries = index.entries();
+        uint64_t const numBlocks = entries.size() - 1;
+        uint64_t const myId = query->getInstanceID();
+        uint64_t const firstBlock = numBlocks * myId / _nInstances;
+        uint64_t const endBlock = numBlocks * (myId + 1) / _nInstances;
+        _firstBlock = firstBlock;
+        _chunkAddress.coords[2] = 0;
+        _cuts.clear();
+        _nextCut = 0;
+        for (uint64_t block = firstBlock; block < endBlock; ++block)
+        {
+            _cuts.push_back(entries[block + 1].offset - entries[block].offset);
+        }
+        if (firstBlock == endBlock)
+        {
+            return 0;
+        }
+        if (lseek(_inputFile, entries[firstBlock].offset, SEEK_SET) < 0)
+        {
+            ostringstream oss;
+            oss << "aio_input() cannot seek in input file (" << strerror(errno) << ")";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+        }
+        LOG4CXX_DEBUG(logger, "aio_input use_index blocks " << firstBlock << " to " << endBlock << " of " << numBlocks
+                      << ", lines from " << entries[firstBlock].firstLine);
+        return entries[endBlock].offset - entries[firstBlock].offset;
+    }
+
+    /**
+     * Open the input file for reading.
+     *
+     * @param filePath The path to the FIFO, pipe, or file to read input from.
+     * @param instanceId The ID of this instance, used only for the exception message
+     *    should this openFile fail.
+     */
+    static int openFile(std::string const& filePath,
+                        InstanceID instanceId)
+    {
+        // Mark this FD as non-blocking because filePath could refer to any
+        // file-like device and we must be able to periodically check for
+        // a valid query.  If we marked this as blocking, then we will end
+        // up stuck forever in a read() in cases where pipes that don't
+        // have data yet in them but the query has been cancelled.
+        auto fd = open(filePath.c_str(), O_RDONLY | O_NONBLOCK);
+
+        if (fd == -1) {
+	    int err = errno;
+            ostringstream errorMsg;
+            errorMsg << "cannot open file '" << filePath << "' on instance " << instanceId
+		     << " (errno=" << err << ", '" << strerror(err) << "')";
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << errorMsg.str().c_str();
+        }
+
+        return fd;
+    }
+
+    virtual ~BinFileSplitArray()
+    {
+        if (_prefetcher.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+                _cond.notify_all();
+            }
+            _prefetcher.join();
+        }
+        closeInput();
+    }
+
+    void closeInput()
+    {
+        // An index not yet written does not cover the whole file; drop it.
+        _index.reset();
+        // The reader may still have reads outstanding against the FD.
+        _reader.reset();
+        if (_inputFile != -1)
+        {
+            ::close(_inputFile);
+            _inputFile = -1;
+        }
+    }
+
+    size_t getCurrentRowIndex() const
+    {
+        return _rowIndex;
+    }
+
+    /**
+     * Read past the header of the input: first some number of lines, then
+     * every following line that starts with a given prefix.
+     *
+     * The input is read in large blocks and searched with memchr (which is
+     * vectorized in glibc) rather than a byte at a time. The data read past
+     * the header is handed back to be delivered ahead of the rest of the
+     * input, unless the caller can seek back to it.
+     *
+     * @param reader The input, positioned at its start.
+     * @param linesToSkip The number of lines in the header to disregard.
+     * @param prefix Lines starting with this are also header; may be empty.
+     * @param lineDelim The character delimiting lines in the input file.
+     * @param[out] remainder The data read past the header.
+     * @return the length of the header in bytes.
+     */
+    static off_t skipHeader(AioReader& reader,
+                            int64_t linesToSkip,
+                            string const& prefix,
+                            char lineDelim,
+                            vector<char>& remainder)
+    {
+        static size_t const HEADER_READ_SIZE = 1024 * 1024;
+        vector<char> buf;
+        size_t pos = 0;           // start of the data not yet examined in buf
+        off_t headerBytes = 0;    // header bytes already dropped from buf
+        bool eof = false;
+        bool inHeaderLine = false;
+        int64_t linesSkipped = 0;
+        // Drop the examined part of buf and append another read to the rest.
+        auto fill = [&]() -> bool {
+            headerBytes += pos;
+            buf.erase(buf.begin(), buf.begin() + pos);
+            pos = 0;
+            if (eof) {
+                return false;
+            }
+            size_t const have = buf.size();
+            buf.resize(have + HEADER_READ_SIZE);
+            size_t const numBytes = reader.read(buf.data() + have, HEADER_READ_SIZE);
+            buf.resize(have + numBytes);
+            eof = (numBytes < HEADER_READ_SIZE);
+            return numBytes > 0;
+        };
+        while (true) {
+            if (inHeaderLine) {
+                auto delim = static_cast<char const*>(memchr(buf.data() + pos, lineDelim, buf.size() - pos));
+                if (delim) {
+                    pos = delim - buf.data() + 1;
+                    inHeaderLine = false;
+                    ++linesSkipped;
+                }
+                else {
+                    pos = buf.size();
+                    if (!fill()) {
+                        break;  // the header runs to the end of the input
+                    }
+                }
+            }
+            else if (linesSkipped < linesToSkip) {
+                inHeaderLine = true;
+            }
+            else if (!prefix.empty() && buf.size() - pos < prefix.size() && !eof) {
+                fill();
+            }
+            else if (!prefix.empty() && buf.size() - pos >= prefix.size() &&
+                     memcmp(buf.data() + pos, prefix.data(), prefix.size()) == 0) {
+                inHeaderLine = true;
+            }
+            else {
+                break;
+            }
+        }
+        remainder.assign(buf.begin() + pos, buf.end());
+        return headerBytes + pos;
+    }
+
+    /**
+     * Fill buf with the next block of input. For line_aligned, the block is
+     * cut after its last line delimiter and the rest carried over to the
+     * start of the next one. For write_index, the block is also entered in
+     * the index of its file; for use_index, it is the next one the index
+     * lists.
+     *
+     * @return the number of bytes filled, 0 only at the end of the input.
+     *    _inputEnded is set once the input has been read and closed.
+     */
+    size_t fillBlock(char* buf)
+    {
+        if (_openNext) {
+            _openNext = false;
+            openNextFile(Query::getValidQueryPtr(_query));
+        }
+        if (_nextCut < _cuts.size()) {
+            return fillIndexedBlock(buf);
+        }
+        size_t numBytes = _carry.size();
+        memcpy(buf, _carry.data(), numBytes);
+        _carry.clear();
+        uint64_t blockStart = _filePos - numBytes;
+        while (numBytes < _fileBlockSize) {
+            AioInputStats::Clock::time_point const readStart = AioInputStats::Clock::now();
+            size_t const n = _reader->read(buf + numBytes, _fileBlockSize - numBytes);
+            _stats->readNanos += AioInputStats::nanosSince(readStart);
+            _stats->bytesRead += n;
+            _filePos += n;
+            numBytes += n;
+            if (n > 0) {
+                _midLine = (buf[numBytes - 1] != _settings->getLineDelimiter());
+            }
+            if (numBytes == _fileBlockSize || _nextFile == _inputFiles.size()) {
+                break;
+            }
+            // This file has ended and another follows; keep filling the block
+            // from that one, ending this file's last line first if need be.
+            if (_midLine) {
+                buf[numBytes++] = _settings->getLineDelimiter();
+            }
+            if (_index) {
+                // An indexed file's blocks hold nothing of other files, so
+                // that every block starts at an offset in the file indexed.
+                if (numBytes > 0) {
+                    _openNext = true;
+                    break;
+                }
+                finishIndex();
+            }
+            if (_checkpoint) {
+                _checkpoint->setOffset(_currentFile, _filePos);
+            }
+            openNextFile(Query::getValidQueryPtr(_query));
+            blockStart = _filePos;
+        }
+        bool const fileDone = (numBytes != _fileBlockSize || _openNext);
+        if (numBytes != _fileBlockSize && !_openNext) {
+            _inputEnded = true;
+        }
+        else if (_lineAligned && !_openNext) {
+            char const lineDelim = _settings->getLineDelimiter();
+            char const* lastDelim = nullptr;
+            if (_settings->getQuote()) {
+                // The block starts a line, outside quotes; only a scan from
+                // there tells which line delimiters are quoted.
+                DelimiterScanner scanner(buf, buf + numBytes, lineDelim, lineDelim, _settings->getQuote());
+                for (char const* delim = scanner.next(); delim != buf + numBytes; delim = scanner.next()) {
+                    lastDelim = delim;
+                }
+            }
+            else {
+                lastDelim = static_cast<char const*>(memrchr(buf, lineDelim, numBytes));
+            }
+            if (lastDelim == nullptr && _settings->getQuote()) {
+                // A quote left open swallows every line end after it, so a
+                // block that has line ends, but none outside quotes, points
+                // at the data rather than at buffer_size.
+                ostringstream oss;
+                oss << "aio_input() found no line end outside quotes in " << numBytes << " bytes of "
+                    << _currentFile << " from near offset " << blockStart << "; ";
+                if (memrchr(buf, lineDelim, numBytes) != nullptr) {
+                    oss << "most likely a quote there is never closed, which makes all the lines after it one field";
+                }
+                else {
+                    oss << "a record is longer than buffer_size; increase buffer_size";
+                }
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+            }
+            if (lastDelim == nullptr) {
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION)
+                    << "line_aligned found a line longer than buffer_size; increase buffer_size";
+            }
+            size_t const blockBytes = lastDelim - buf + 1;
+            _carry.assign(buf + blockBytes, buf + numBytes);
+            numBytes = blockBytes;
+        }
+        if (_index) {
+            if (numBytes > 0) {
+                indexBlock(buf, numBytes, blockStart);
+            }
+            if (fileDone) {
+                finishIndex();
+            }
+        }
+        if (numBytes > 0) {
+            ++_blocksFilled;
+        }
+        if (_checkpoint) {
+            // The data carried over to the next block is not loaded yet.
+            _checkpoint->setOffset(_currentFile, _filePos - _carry.size());
+            if (_inputEnded) {
+                _checkpoint->complete(_firstBlock + _blocksFilled);
+            }
+        }
+        if (_inputEnded) {
+            closeInput();
+        }
+        return numBytes;
+    }
+
+    /**
+     * For use_index, fill buf with exactly the next of this instance's
+     * blocks, which the index says holds whole lines.
+     */
+    size_t fillIndexedBlock(char* buf)
+    {
+        size_t const wanted = _cuts[_nextCut++];
+        AioInputStats::Clock::time_point const readStart = AioInputStats::Clock::now();
+        size_t const numBytes = _reader->read(buf, wanted);
+        _stats->readNanos += AioInputStats::nanosSince(readStart);
+        _stats->bytesRead += numBytes;
+        if (numBytes != wanted) {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION)
+                << "aio_input() input file is shorter than its line index says";
+        }
+        if (_nextCut == _cuts.size()) {
+            _inputEnded = true;
+            closeInput();
+        }
+        return numBytes;
+    }
+
+    /**
+     * Add an entry for the block of numBytes at buf, which starts at
+     * blockStart in the current file, to its index.
+     */
+    void indexBlock(char const* buf, size_t numBytes, uint64_t blockStart)
+    {
+        char const lineDelim = _settings->getLineDelimiter();
+        LineIndex::Entry entry{blockStart, _fileLines, std::numeric_limits<uint32_t>::max(), 0};
+        uint32_t fields = 1;
+        auto endLine = [&]() {
+            entry.minFields = std::min(entry.minFields, fields);
+            entry.maxFields = std::max(entry.maxFields, fields);
+            fields = 1;
+            ++_fileLines;
+        };
+        DelimiterScanner scanner(buf, buf + numBytes, _settings->getAttributeDelimiter(), lineDelim, _settings->getQuote());
+        for (char const* delim = scanner.next(); delim != buf + numBytes; delim = scanner.next()) {
+            if (*delim == lineDelim) {
+                endLine();
+            }
+            else {
+                ++fields;
+            }
+        }
+        if (buf[numBytes - 1] != lineDelim) {
+            endLine();
+        }
+        _index->add(entry);
+    }
+
+    /**
+     * Write the index of the current file, all of whose data is in blocks.
+     */
+    void finishIndex()
+    {
+        _index->write(_indexPath, _filePos, _fileLines);
+        _index.reset();
+    }
+
+    /**
+     * Body of the read-ahead thread: fill blocks in ring order, staying up to
+     * _readAhead blocks ahead of moveNext, until the input ends.
+     */
+    void prefetch()
+    {
+        try
+        {
+            while (!_inputEnded)
+            {
+                size_t slot;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cond.wait(lock, [this] { return _stopping || _produced - _consumed < _readAhead; });
+                    if (_stopping)
+                    {
+                        break;
+                    }
+                    slot = _produced % _blocks.size();
+                }
+                // The block in slot is neither handed out nor about to be,
+                // so it can be filled without holding the lock.
+                size_t const numBytes = fillBlock(_blocks[slot]->data);
+                std::lock_guard<std::mutex> lock(_mutex);
+                _blockBytes[slot] = numBytes;
+                ++_produced;
+                _cond.notify_all();
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _producerDone = true;
+        _cond.notify_all();
+    }
+
+    /**
+     * Take the next block filled by the read-ahead thread, releasing the one
+     * handed out before it.
+     *
+     * @return the number of bytes in the block, which becomes _current.
+     */
+    size_t takePrefetchedBlock()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_consumed == _produced)
+        {
+            if (_error)
+            {
+                std::rethrow_exception(_error);
+            }
+            if (_producerDone)
+            {
+                return 0;
+            }
+            if (!_cond.wait_for(lock, std::chrono::seconds(1), [this] { return _producerDone || _consumed < _produced; }))
+            {
+                // Still waiting on the input; make sure the query is still alive.
+                Query::getValidQueryPtr(_query);
+            }
+        }
+        _current = _consumed % _blocks.size();
+        ++_consumed;
+        _cond.notify_all();
+        return _blockBytes[_current];
+    }
+
+    bool moveNext(size_t rowIndex)
+    {
+        if (_endOfFile) {
+            return false;
+        }
+        size_t const numBytes = _readAhead > 0 ? takePrefetchedBlock() : fillBlock(_blocks[_current]->data);
+        if (numBytes == 0) {
+            _endOfFile = true;
+            return false;
+        }
+        if (_readAhead == 0 && _inputEnded) {
+            _endOfFile = true;
+        }
+        *_blocks[_current]->size = (uint32_t) numBytes;
+        ++_rowIndex;
+        return true;
+    }
+
+    /**
+     * @return false once moveNext has run out of input.
+     */
+    bool hasMoreInput() const
+    {
+        return !_endOfFile;
+    }
+
+    ConstChunk const& getChunk(AttributeID attr, size_t rowIndex)
+    {
+        // Successive blocks go round-robin to successive instances, starting
+        // with the instance whose ID is the number of the first block.
+        Coordinate const block = _firstBlock + _rowIndex - 1;
+        _chunkAddress.coords[0] = block / _nInstances;
+        _chunkAddress.coords[1] = block % _nInstances;
+        shared_ptr<Query> query = Query::getValidQueryPtr(_query);
+        MemChunk& chunk = _blocks[_current]->chunk;
+        chunk.initialize(this, &super::getArrayDesc(), _chunkAddress, CompressorType::NONE);
+        return chunk;
+    }
+};
+
+/**
+ * One wave of a streaming load: hands out at most a given number of the
+ * blocks of a BinFileSplitArray, which carries on where the previous wave
+ * stopped, so that each wave can be redistributed and parsed on its own.
+ */
+class BlockWaveArray : public SinglePassArray
+{
+private:
+    typedef SinglePassArray super;
+    shared_ptr<BinFileSplitArray> const _source;
+    size_t const _maxBlocks;
+    size_t _rowIndex;
+
+public:
+    BlockWaveArray(ArrayDesc const& schema, shared_ptr<BinFileSplitArray> const& source, size_t maxBlocks):
+        super(schema),
+        _source(source),
+        _maxBlocks(maxBlocks),
+        _rowIndex(0)
+    {
+        super::setEnforceHorizontalIteration(true);
+    }
+
+    size_t getCurrentRowIndex() const
+    {
+        return _rowIndex;
+    }
+
+    bool moveNext(size_t rowIndex)
+    {
+        if (_rowIndex == _maxBlocks || !_source->moveNext(_source->getCurrentRowIndex() + 1))
+        {
+            return false;
+        }
+        ++_rowIndex;
+        return true;
+    }
+
+    ConstChunk const& getChunk(AttributeID attr, size_t rowIndex)
+    {
+        return _source->getChunk(attr, _source->getCurrentRowIndex());
+    }
+};
+
+/**
+ * Converts the text of a field to the type of the attribute it is loaded
+ * into, without allocating: integers with std::from_chars, floating point
+ * with strtod_l/strtof_l on a copy in a stack buffer, since the field is not
+ * NUL-terminated. Numbers are taken as strictly as from_chars takes
+ * integers: no spaces, no hexadecimal, no inf or nan, and '.' as the
+ * decimal point whatever the locale.
+ */
+class FieldConverter
+{
+private:
+    static size_t const FLOAT_BUFFER_SIZE = 64;
+    template<typename T>
+    static bool parseInteger(char const* start, char const* end, T& out)
+    {
+        if (start != end && *start == '+' && end - start > 1 && start[1] != '-')
+        {
+            ++start;
+        }
+        std::from_chars_result const result = std::from_chars(start, end, out);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    /**
+     * @return whether [start, end) is a decimal number: an optional sign,
+     *    digits with at most one '.' among them and at least one digit, and
+     *    an optional exponent of 'e' or 'E', an optional sign and digits.
+     */
+    static bool isDecimal(char const* p, char const* end)
+    {
+        if (p != end && (*p == '+' || *p == '-'))
+        {
+            ++p;
+        }
+        size_t digits = 0;
+        bool point = false;
+        for (; p != end; ++p)
+        {
+            if (*p >= '0' && *p <= '9')
+            {
+                ++digits;
+            }
+            else if (*p == '.' && !point)
+            {
+                point = true;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (digits == 0)
+        {
+            return false;
+        }
+        if (p != end && (*p == 'e' || *p == 'E'))
+        {
+            ++p;
+            if (p != end && (*p == '+' || *p == '-'))
+            {
+                ++p;
+            }
+            char const* const exponent = p;
+            while (p != end && *p >= '0' && *p <= '9')
+            {
+                ++p;
+            }
+            if (p == exponent)
+            {
+                return false;
+            }
+        }
+        return p == end;
+    }
+
+    // The "C" locale, for a '.' decimal point in strtod whatever the
+    // process locale is.
+    static locale_t cLocale()
+    {
+        static locale_t const locale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+        return locale;
+    }
+
+    /**
+     * Fields of up to FLOAT_BUFFER_SIZE - 1 characters are copied to the
+     * stack for parse; longer ones, such as numbers with many digits after
+     * the point, to the heap. Like an integer out of range, a number too
+     * large for T is rejected rather than taken as infinity.
+     */
+    template<typename T>
+    static bool parseFloat(char const* start, char const* end, T (*parse)(char const*, char**, locale_t), T& out)
+    {
+        if (!isDecimal(start, end))
+        {
+            return false;
+        }
+        char buf[FLOAT_BUFFER_SIZE];
+        size_t const size = end - start;
+        if (size >= sizeof(buf))
+        {
+            string const text(start, end);
+            out = parse(text.c_str(), nullptr, cLocale());
+        }
+        else
+        {
+            memcpy(buf, start, size);
+            buf[size] = 0;
+            out = parse(buf, nullptr, cLocale());
+        }
+        return !std::isinf(out);
+    }
+
+    static bool parseBool(char const* start, char const* end, bool& out)
+    {
+        size_t const size = end - start;
+        if ((size == 4 && strncasecmp(start, "true", 4) == 0) || (size == 1 && *start == '1'))
+        {
+            out = true;
+            return true;
+        }
+        if ((size == 5 && strncasecmp(start, "false", 5) == 0) || (size == 1 && *start == '0'))
+        {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+
+    template<typename T, typename Setter>
+    static bool convertInteger(char const* start, char const* end, Value& out, Setter set)
+    {
+        T v;
+        if (!parseInteger(start, end, v))
+        {
+            return false;
+        }
+        (out.*set)(v);
+        return true;
+    }
+
+public:
+    /**
+     * @return whether [start, end) is a number, put in out if so.
+     */
+    static bool parseDouble(char const* start, char const* end, double& out)
+    {
+        return parseFloat<double>(start, end, &strtod_l, out);
+    }
+
+    /**
+     * @return whether [start, end) is an int64, put in out if so.
+     */
+    static bool parseInt64(char const* start, char const* end, int64_t& out)
+    {
+        return parseInteger(start, end, out);
+    }
+
+    /**
+     * Convert the non-empty field [start, end) to type.
+     *
+     * @param type The attribute type: one of the TypeEnums listed below.
+     * @param out Receives the value.
+     * @return false if the field is not a valid value of type; out is then
+     *    unchanged.
+     */
+    static bool convert(TypeEnum type, char const* start, char const* end, Value& out)
+    {
+        switch (type)
+        {
+        case TE_BOOL:
+        {
+            bool v;
+            if (!parseBool(start, end, v))
+            {
+                return false;
+            }
+            out.setBool(v);
+            return true;
+        }
+        case TE_INT8:   return convertInteger<int8_t>(start, end, out, &Value::setInt8);
+        case TE_INT16:  return convertInteger<int16_t>(start, end, out, &Value::setInt16);
+        case TE_INT32:  return convertInteger<int32_t>(start, end, out, &Value::setInt32);
+        case TE_INT64:  return convertInteger<int64_t>(start, end, out, &Value::setInt64);
+        case TE_UINT8:  return convertInteger<uint8_t>(start, end, out, &Value::setUint8);
+        case TE_UINT16: return convertInteger<uint16_t>(start, end, out, &Value::setUint16);
+        case TE_UINT32: return convertInteger<uint32_t>(start, end, out, &Value::setUint32);
+        case TE_UINT64: return convertInteger<uint64_t>(start, end, out, &Value::setUint64);
+        case TE_FLOAT:
+        {
+            float v;
+            if (!parseFloat<float>(start, end, &strtof_l, v))
+            {
+                return false;
+            }
+            out.setFloat(v);
+            return true;
+        }
+        case TE_DOUBLE:
+        {
+            double v;
+            if (!parseFloat<double>(start, end, &strtod_l, v))
+            {
+                return false;
+            }
+            out.setDouble(v);
+            return true;
+        }
+        default:
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "[defensive] aio_input cannot convert to this type";
+        }
+    }
+
+    /**
+     * If [start, end) is a quoted field, point it at its text instead: the
+     * part between the quotes, with doubled quotes made single. Anything
+     * after the closing quote is kept as is.
+     *
+     * @param scratch Holds the text.
+     */
+    static void unquote(char const*& start, char const*& end, char quote, string& scratch)
+    {
+        if (quote == 0 || start == end || *start != quote)
+        {
+            return;
+        }
+        scratch.clear();
+        char const* p = start + 1;
+        while (p != end)
+        {
+            if (*p != quote)
+            {
+                scratch.push_back(*p++);
+            }
+            else if (p + 1 != end && p[1] == quote)
+            {
+                scratch.push_back(quote);
+                p += 2;
+            }
+            else
+            {
+                scratch.append(p + 1, end);
+                break;
+            }
+        }
+        start = scratch.data();
+        end = start + scratch.size();
+    }
+
+    /**
+     * @return the TypeEnum of each of the first count attributes of schema.
+     */
+    static vector<TypeEnum> attributeTypes(ArrayDesc const& schema, size_t count)
+    {
+        vector<TypeEnum> types;
+        for (const auto& attr : schema.getAttributes(/*excludeEbm:*/true))
+        {
+            if (types.size() == count)
+            {
+                break;
+            }
+            types.push_back(typeId2TypeEnum(attr.getType(), true));
+        }
+        return types;
+    }
+};
+
+class AIOOutputWriter : public boost::noncopyable
+{
+private:
+    shared_ptr<Array> const _output;
+    Coordinates _outputPosition;
+    size_t const _numLiveAttributes;
+    size_t const _outputLineSize;
+    vector<size_t> const _columnAttributes;
+    size_t const _numColumns;
+    size_t const _outputChunkSize;
+    vector<shared_ptr<ArrayIterator> > _outputArrayIterators;
+    vector<shared_ptr<ChunkIterator> > _outputChunkIterators;
+    bool _splitOnDimension;
+    size_t _outputColumn;
+    char const _attributeDelimiter;
+    vector<Value> _buf;
+    ostringstream _errorBuf;
+    Value _errorBufVal;
+    Coordinate _outputPositionLimit;
+    vector<TypeEnum> const _types;     // of the columns before 'error'
+    vector<string> _names;
+    char const _quote;
+    string _unquoted;
+
+    // Start the next entry of the error message.
+    ostringstream& errorEntry()
+    {
+        if (_errorBuf.tellp() > 0)
+        {
+            _errorBuf << "; ";
+        }
+        return _errorBuf;
+    }
+
+public:
+    /**
+     * @param columnAttributes For each column of the input, the index of the
+     *    output attribute (or attribute_no) it goes to, or
+     *    AioInputSettings::NO_ATTRIBUTE if it is not loaded.
+     */
+    AIOOutputWriter(ArrayDesc const& schema, shared_ptr<Query>& query, bool splitOnDimension, char const attDelimiter, char const quote,
+                    vector<size_t> const& columnAttributes):
+        _output(std::make_shared<MemArray>(schema,query)),
+        _outputPosition( splitOnDimension ? 4 : 3, 0),
+        _numLiveAttributes(schema.getAttributes(true).size()),
+        _outputLineSize(splitOnDimension ? schema.getDimensions()[3].getChunkInterval() : _numLiveAttributes),
+        _columnAttributes(columnAttributes),
+        _numColumns(columnAttributes.size()),
+        _outputChunkSize(schema.getDimensions()[0].getChunkInterval()),
+        _outputArrayIterators(_numLiveAttributes),
+        _outputChunkIterators(_numLiveAttributes),
+        _splitOnDimension(splitOnDimension),
+        _outputColumn(0),
+        _attributeDelimiter(attDelimiter),
+        _buf(_outputLineSize-1),
+        _types(splitOnDimension ? vector<TypeEnum>(_outputLineSize-1, TE_STRING) : FieldConverter::attributeTypes(schema, _outputLineSize-1)),
+        _quote(quote)
+    {
+/*        for(AttributeID i =0; i<_numLiveAttributes; ++i)
+        {
+            _outputArrayIterators[i] = _output->getIterator(i);
+            }*/
+        for (const auto& attr : schema.getAttributes(/*excludeEbm:*/true))
+        {
+            _outputArrayIterators[attr.getId()] = _output->getIterator(attr);
+            _names.push_back(attr.getName());
+        }
+    }
+
+    void newChunk (Coordinates const& inputChunkPosition, shared_ptr<Query>& query)
+    {
+        _outputPosition[0] = inputChunkPosition[0] * _outputChunkSize;
+        _outputPositionLimit = _outputPosition[0] + _outputChunkSize;
+        _outputPosition[1] = inputChunkPosition[1];
+        _outputPosition[2] = inputChunkPosition[2];
+        if(_splitOnDimension)
+        {
+            _outputPosition[3] = 0;
+        }
+        for(AttributeID i =0; i<_numLiveAttributes; ++i)
+        {
+            if(_outputChunkIterators[i].get())
+            {
+                _outputChunkIterators[i]->flush();
+            }
+            _outputChunkIterators[i] = _outputArrayIterators[i]->newChunk(_outputPosition).getIterator(query,
+                i == 0 ? ChunkIterator::SEQUENTIAL_WRITE : ChunkIterator::SEQUENTIAL_WRITE | ChunkIterator::NO_EMPTY_CHECK);
+        }
+    }
+
+    /**
+     * @param converted The value of a converted field, as the cache
+     *    converted it; null for a field not converted.
+     * @param failed Whether the field did not convert.
+     */
+    void writeValue (char const* start, char const* end, Value const* converted, bool failed)
+    {
+        if(_outputPosition[0] >= _outputPositionLimit)
+        {
+            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "The chunk size is too small for the current block size. Lower the block size or increase chunk size";
+        }
+        if(_outputColumn < _numColumns)
+        {
+            size_t const attr = _columnAttributes[_outputColumn];
+            ++_outputColumn;
+            if (attr == AioInputSettings::NO_ATTRIBUTE)
+            {
+                return;
+            }
+            Value& buf = _buf[attr];
+            Value const* item = &buf;
+            TypeEnum const type = _types[attr];
+            if (type == TE_STRING)
+            {
+                FieldConverter::unquote(start, end, _quote, _unquoted);
+                buf.setSize<Value::IGNORE_DATA>(end - start + 1);
+                char* d = buf.getData<char>();
+                memcpy(d, start, end-start);
+                d[(end-start)]=0;
+            }
+            else if (converted)
+            {
+                item = converted;
+                if (failed)
+                {
+                    errorEntry() << _names[attr] << " not " << typeEnum2TypeId(type);
+                }
+            }
+            else
+            {
+                buf.setNull();  // an empty field
+            }
+            if(_splitOnDimension)
+            {
+                _outputChunkIterators[0] -> setPosition(_outputPosition);
+                _outputChunkIterators[0] -> writeItem(*item);
+                ++(_outputPosition[3]);
+            }
+            else
+            {
+                _outputChunkIterators[attr] -> setPosition(_outputPosition);
+                _outputChunkIterators[attr] -> writeItem(*item);
+            }
+            return;
+        }
+        FieldConverter::unquote(start, end, _quote, _unquoted);
+        if (_outputColumn == _numColumns)
+        {
+            string value(start, end-start);
+            errorEntry() << "long" << _attributeDelimiter << value;
+        }
+        else
+        {
+            string value(start, end-start);
+            _errorBuf << _attributeDelimiter << value;
+        }
+        ++_outputColumn;
+    }
+
+    void endLine()
+    {
+        if(_outputColumn < _numColumns)
+        {
+            _errorBufVal.setNull();
+            for (; _outputColumn < _numColumns; ++_outputColumn)
+            {
+                size_t const attr = _columnAttributes[_outputColumn];
+                if (attr == AioInputSettings::NO_ATTRIBUTE)
+                {
+                    continue;
+                }
+                if(_splitOnDimension)
+                {
+                    _outputChunkIterators[0] -> setPosition(_outputPosition);
+                    _outputChunkIterators[0] -> writeItem(_errorBufVal);
+                    ++(_outputPosition[3]);
+                }
+                else
+                {
+                    _outputChunkIterators[attr] -> setPosition(_outputPosition);
+                    _outputChunkIterators[attr] -> writeItem(_errorBufVal);
+                }
+            }
+            errorEntry() << "short";
         }
         if(_errorBuf.str().size())
         {
-            _errorBufVal.setString(_errorBuf.str());
-            _errorBuf.str("");
+            _errorBufVal.setString(_errorBuf.str());
+            _errorBuf.str("");
+        }
+        else
+        {
+            _errorBufVal.setNull();
+        }
+        if(_splitOnDimension)
+        {
+            _outputChunkIterators[0] -> setPosition(_outputPosition);
+            _outputChunkIterators[0] -> writeItem(_errorBufVal);
+            _outputPosition[3] = 0;
+        }
+        else
+        {
+            _outputChunkIterators[_outputLineSize - 1] -> setPosition(_outputPosition);
+            _outputChunkIterators[_outputLineSize - 1] -> writeItem(_errorBufVal);
+        }
+        ++(_outputPosition[0]);
+        _outputColumn = 0;
+    }
+
+    shared_ptr<Array> finalize()
+    {
+        for(AttributeID i =0; i<_numLiveAttributes; ++i)
+        {
+            if(_outputChunkIterators[i].get())
+            {
+                _outputChunkIterators[i]->flush();
+            }
+            _outputChunkIterators[i].reset();
+            _outputArrayIterators[i].reset();
+        }
+        return _output;
+    }
+};
+
+/**
+ * Class AIOOutputCache
+ *
+ * Tracks all of the pieces of the input buffer that make up the chunks
+ * written for any given line in the input file.  Allows us to know
+ * before we write any chunks for a line of the input if that line has
+ * an error that would cause the 'error' attribute not to be null.
+ *
+ * The pieces are kept as a structure of arrays: per field, the offset of
+ * the delimiter that ends it; per line, the offset of its first byte, the
+ * index of its first field and an error bit. Offsets are relative to the
+ * start of the segment, a contiguous run of input, the line lies in; a
+ * field starts one past the end of the field before it on the same line.
+ * A field of a typed column is converted once, to find out whether it has
+ * an error, and the value is kept for the writer with its own error bit;
+ * per line, the index of its first value is kept too.
+ *
+ * Assumes that the lifetime of the buffer read from the file is longer
+ * than the lifetime of this object.
+ */
+class AIOOutputCache
+{
+private:
+    size_t const _outputLineSize;
+    size_t _outputColumn;
+    AioInputSettings::Skip _skip;
+    bool _hasError{false};
+    vector<TypeEnum> _types;  // of the columns before 'error', if any is typed
+    char _quote;
+    string _unquoted;
+    uint64_t _lines{0};
+    uint64_t _errorLines{0};
+    uint64_t _skippedLines{0};
+    uint64_t _filteredLines{0};
+    uint64_t _sampledOutLines{0};
+
+    // The 'where' predicates by input column, their number, and how many
+    // the current line has passed so far.
+    typedef AioInputSettings::Predicate Predicate;
+    vector<vector<Predicate> > _predicates;
+    size_t _numPredicates{0};
+    size_t _predicatesPassed{0};
+
+    // A contiguous stretch of input and the index of its first line.
+    struct Segment
+    {
+        char const* base;
+        uint32_t    firstLine;
+    };
+
+    // Everything AIOOutputWriter would have been told while reading the
+    // input chunk, remembered here instead and inspected before any writing
+    // to the output array chunks takes place, allowing the 'skip' parameter
+    // to have its effect if configured.
+    Coordinates      _chunkPosition;
+    bool             _hasChunk{false};
+    vector<Segment>  _segments;
+    vector<uint32_t> _lineStarts;
+    vector<uint32_t> _lineFields;
+    vector<bool>     _lineErrors;
+    vector<uint32_t> _fieldEnds;
+    vector<uint32_t> _lineValues;
+    vector<Value>    _values;
+    vector<bool>     _valueErrors;
+
+    // Whether the field in column of [start, end) is converted: a non-empty
+    // field of a typed column.
+    bool converts(size_t column, char const* start, char const* end) const
+    {
+        return column < _outputLineSize - 1 && !_types.empty() && _types[column] != TE_STRING && start != end;
+    }
+
+    bool matches(Predicate const& predicate, char const* start, char const* end)
+    {
+        FieldConverter::unquote(start, end, _quote, _unquoted);
+        size_t const size = end - start;
+        switch (predicate.op) {
+        case Predicate::EQ:
+            return size == predicate.values[0].size() && memcmp(start, predicate.values[0].data(), size) == 0;
+        case Predicate::PREFIX:
+            return size >= predicate.values[0].size() && memcmp(start, predicate.values[0].data(), predicate.values[0].size()) == 0;
+        case Predicate::IN:
+            for (string const& value : predicate.values) {
+                if (size == value.size() && memcmp(start, value.data(), size) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        case Predicate::BETWEEN:
+        {
+            double number;
+            return size > 0 && FieldConverter::parseDouble(start, end, number)
+                && number >= predicate.low && number <= predicate.high;
+        }
+        }
+        return false;
+    }
+
+    bool skipped(bool hasError) const
+    {
+        return (_skip == AioInputSettings::Skip::ERRORS && hasError)
+            || (_skip == AioInputSettings::Skip::NON_ERRORS && !hasError);
+    }
+
+public:
+    /**
+     * @param numColumns The number of fields a line must have.
+     * @param types The type each field converts to; empty if all are strings.
+     * @param skip Which lines to leave out of the playback.
+     * @param quote The character that quotes fields, 0 for none.
+     * @param predicates The 'where' predicates a line must pass to be kept.
+     */
+    AIOOutputCache(size_t numColumns,
+                   vector<TypeEnum> const& types,
+                   AioInputSettings::Skip skip,
+                   char quote,
+                   vector<Predicate> const& predicates)
+        : _outputLineSize(numColumns + 1)
+        , _outputColumn(0)
+        , _skip(skip)
+        , _types(types)
+        , _quote(quote)
+    {
+        for (Predicate const& predicate : predicates) {
+            _predicates.resize(numColumns);
+            _predicates[predicate.column].push_back(predicate);
+            ++_numPredicates;
+        }
+        if (std::all_of(_types.begin(), _types.end(), [](TypeEnum t) { return t == TE_STRING; })) {
+            _types.clear();
+        }
+    }
+
+    /**
+     * This duplicates the initialization and setup of the AIOOutputWriter::newChunk
+     * method but without committing anything to the output chunks.
+     *
+     * @param inputChunkPosition The upper left corner of the input chunk.
+     * @param query The query.
+     */
+    void newChunk(Coordinates const& inputChunkPosition, shared_ptr<Query>& query)
+    {
+        _chunkPosition = inputChunkPosition;
+        _hasChunk = true;
+    }
+
+    /**
+     * Start a new segment: the values passed to writeValue until the next
+     * call lie in the buffer that starts at base, within 4GB of it.
+     *
+     * @param base The start of the buffer.
+     */
+    void newSegment(char const* base)
+    {
+        _segments.push_back(Segment{base, static_cast<uint32_t>(_lineStarts.size())});
+    }
+
+    /**
+     * This duplicates the column and offset math of the AIOOutputWriter::writeValue
+     * method but without committing anything to the output chunks, allowing us to
+     * know if there would be an error at this line before writing to the output array.
+     *
+     * @param start A pointer to the start of a memory region containing the value
+     *    to write to the next output chunk.
+     * @param end  A pointer to the end of the memory region containing the value
+     *    to write to the next output chunk.
+     */
+    void writeValue(char const* start, char const* end)
+    {
+        char const* base = _segments.back().base;
+        if (_outputColumn == 0) {
+            _lineStarts.push_back(static_cast<uint32_t>(start - base));
+            _lineFields.push_back(static_cast<uint32_t>(_fieldEnds.size()));
+            _lineValues.push_back(static_cast<uint32_t>(_values.size()));
+        }
+        if (_outputColumn >= _outputLineSize - 1) {
+            _hasError = true;
+        }
+        else if (!_predicates.empty() && _predicatesPassed != _numPredicates) {
+            for (Predicate const& predicate : _predicates[_outputColumn]) {
+                if (matches(predicate, start, end)) {
+                    ++_predicatesPassed;
+                }
+            }
+        }
+        if (converts(_outputColumn, start, end)) {
+            char const* text = start;
+            char const* textEnd = end;
+            FieldConverter::unquote(text, textEnd, _quote, _unquoted);
+            _values.emplace_back();
+            Value& value = _values.back();
+            bool failed = false;
+            if (text == textEnd) {
+                value.setNull();
+            }
+            else if (!FieldConverter::convert(_types[_outputColumn], text, textEnd, value)) {
+                value.setNull();
+                failed = true;
+                _hasError = true;
+            }
+            _valueErrors.push_back(failed);
+        }
+
+        ++_outputColumn;
+
+        _fieldEnds.push_back(static_cast<uint32_t>(end - base));
+    }
+
+    /**
+     * This duplicates the column and offset math of the AIOOutputWriter::endLine
+     * method but without committing anything to the output chunks, allowing us to
+     * know if there would be an error at this line before writing to the output array.
+     */
+    void endLine()
+    {
+        if (_outputColumn < _outputLineSize - 1) {
+            _hasError = true;
+        }
+
+        _outputColumn = 0;
+
+        ++_lines;
+        if (_predicatesPassed != _numPredicates) {
+            // Filtered out by 'where': the line leaves the index before
+            // anything is written for it.
+            _fieldEnds.resize(_lineFields.back());
+            _values.resize(_lineValues.back());
+            _valueErrors.resize(_lineValues.back());
+            _lineStarts.pop_back();
+            _lineFields.pop_back();
+            _lineValues.pop_back();
+            ++_filteredLines;
+            _predicatesPassed = 0;
+            _hasError = false;
+            return;
+        }
+        _predicatesPassed = 0;
+        _lineErrors.push_back(_hasError);
+        if (_hasError) {
+            ++_errorLines;
+        }
+        if (skipped(_hasError)) {
+            ++_skippedLines;
+        }
+        _hasError = false;
+    }
+
+    /**
+     * Count a line left out by 'sample', which is never tokenized.
+     */
+    void sampleOut()
+    {
+        ++_lines;
+        ++_sampledOutLines;
+    }
+
+    /**
+     * Add the numbers of lines seen so far, of those with errors, of those
+     * dropped by 'skip', 'where' and 'sample' to the stats.
+     */
+    void countLines(AioInputStats& stats) const
+    {
+        stats.lines += _lines;
+        stats.errorLines += _errorLines;
+        stats.skippedLines += _skippedLines;
+        stats.filteredLines += _filteredLines;
+        stats.sampledOutLines += _sampledOutLines;
+    }
+
+    /**
+     * Playback all of the lines recorded while processing the input chunk
+     * of the file, modulo any dropped due to an error, depending on the
+     * 'skip' parameter. Converted fields are passed with their value and
+     * whether the conversion failed, the others with a null value.
+     *
+     * @param query The query.
+     * @param writer The instance of the AIOOutputWriter (or AIOTargetWriter)
+     *     that owns the output array and its chunks.
+     */
+    template<typename Writer>
+    void playback(std::shared_ptr<Query> query,
+                  Writer& writer)
+    {
+        size_t const numLines = _lineStarts.size();
+        bool anyKept = false;
+        for (size_t line = 0; line < numLines && !anyKept; ++line) {
+            anyKept = !skipped(_lineErrors[line]);
+        }
+        // If every line on this chunk was dropped, don't start the
+        // chunk, because that would create a chunk that has nothing
+        // on it.
+        if (_hasChunk && anyKept) {
+            writer.newChunk(_chunkPosition, query);
+            for (size_t seg = 0; seg < _segments.size(); ++seg) {
+                char const* base = _segments[seg].base;
+                size_t const segmentEnd = seg + 1 < _segments.size() ? _segments[seg + 1].firstLine : numLines;
+                for (size_t line = _segments[seg].firstLine; line < segmentEnd; ++line) {
+                    if (skipped(_lineErrors[line])) {
+                        continue;
+                    }
+                    size_t const fieldsEnd = line + 1 < numLines ? _lineFields[line + 1] : _fieldEnds.size();
+                    char const* start = base + _lineStarts[line];
+                    size_t value = _lineValues[line];
+                    for (size_t field = _lineFields[line]; field < fieldsEnd; ++field) {
+                        char const* end = base + _fieldEnds[field];
+                        if (converts(field - _lineFields[line], start, end)) {
+                            writer.writeValue(start, end, &_values[value], _valueErrors[value]);
+                            ++value;
+                        }
+                        else {
+                            writer.writeValue(start, end, nullptr, false);
+                        }
+                        start = end + 1;
+                    }
+                    writer.endLine();
+                }
+            }
+        }
+
+        _hasChunk = false;
+        _segments.clear();
+        _lineStarts.clear();
+        _lineFields.clear();
+        _lineErrors.clear();
+        _fieldEnds.clear();
+        _lineValues.clear();
+        _values.clear();
+        _valueErrors.clear();
+    }
+};
+
+/**
+ * Class AIOTargetWriter
+ *
+ * Takes the same calls as AIOOutputWriter, but loads each line as one cell
+ * of a target schema: the columns mapped to dimensions give its position,
+ * the ones mapped to attributes its values. Cells are kept in buckets by
+ * the target chunk they fall in, whatever block they came from, and are
+ * written out chunk by chunk in finalize. Lines that cannot be placed, for
+ * a missing or out of bounds coordinate or a null in a non-nullable
+ * attribute, are dropped and counted.
+ *
+ * The buckets are bounded: once they hold about MAX_BUFFERED_BYTES, they
+ * are written to a spill array, a MemArray whose chunks the buffer cache
+ * can evict, each into a chunk of its own along an extra dimension that
+ * numbers the spills. finalize then gathers every target chunk from the
+ * spills and the buckets, one chunk at a time.
+ */
+class AIOTargetWriter : public boost::noncopyable
+{
+private:
+    typedef AioInputSettings::TargetColumn TargetColumn;
+
+    static size_t const MAX_BUFFERED_BYTES = 64 * 1024 * 1024;
+
+    // The cells of one target chunk, nDims coordinates and nAttrs values each.
+    struct Bucket
+    {
+        vector<Coordinate> coordinates;
+        vector<Value>      values;
+    };
+
+    ArrayDesc const _schema;
+    Dimensions const& _dims;
+    vector<TargetColumn> const _columns;
+    vector<TypeEnum> _attrTypes;
+    vector<bool> _attrNullable;
+    size_t _column;
+    bool _rejected;
+    Coordinates _cell;
+    Coordinates _chunkPosition;
+    vector<Value> _values;
+    std::map<Coordinates, Bucket> _buckets;
+    size_t _bufferedBytes;
+    shared_ptr<Array> _spill;
+    vector<shared_ptr<ArrayIterator> > _spillIterators;
+    Coordinate _numSpills;
+    std::map<Coordinates, vector<Coordinate> > _spilled;  // spill numbers by target chunk
+    uint64_t _rejectedLines;
+    char const _quote;
+    string _unquoted;
+    weak_ptr<Query> _query;
+
+public:
+    AIOTargetWriter(ArrayDesc const& schema, vector<TargetColumn> const& columns, char quote, shared_ptr<Query>& query):
+        _schema(schema),
+        _dims(_schema.getDimensions()),
+        _columns(columns),
+        _column(0),
+        _rejected(false),
+        _cell(_dims.size()),
+        _chunkPosition(_dims.size()),
+        _bufferedBytes(0),
+        _numSpills(0),
+        _rejectedLines(0),
+        _quote(quote),
+        _query(query)
+    {
+        for (const auto& attr : _schema.getAttributes(/*excludeEbm:*/true))
+        {
+            _attrTypes.push_back(typeId2TypeEnum(attr.getType(), true));
+            _attrNullable.push_back(attr.isNullable());
+        }
+        _values.resize(_attrTypes.size());
+        resetLine();
+    }
+
+    /**
+     * Types of the input columns, for the cache's checks.
+     */
+    static vector<TypeEnum> columnTypes(ArrayDesc const& schema, vector<TargetColumn> const& columns)
+    {
+        vector<AttributeDesc> attrs(schema.getAttributes(true).begin(), schema.getAttributes(true).end());
+        vector<TypeEnum> types;
+        for (TargetColumn const& column : columns)
+        {
+            types.push_back(column.role == TargetColumn::DIMENSION ? TE_INT64 :
+                            column.role == TargetColumn::ATTRIBUTE ? typeId2TypeEnum(attrs[column.index].getType(), true) :
+                            TE_STRING);
+        }
+        return types;
+    }
+
+    void newChunk(Coordinates const& inputChunkPosition, shared_ptr<Query>& query)
+    {}
+
+    /**
+     * Dimension and typed attribute fields come converted by the cache,
+     * with the types of columnTypes.
+     */
+    void writeValue(char const* start, char const* end, Value const* converted, bool failed)
+    {
+        if (_column >= _columns.size())
+        {
+            _rejected = true;
+            return;
+        }
+        TargetColumn const& column = _columns[_column++];
+        if (_rejected || column.role == TargetColumn::IGNORED)
+        {
+            return;
+        }
+        bool const valid = converted && !failed && !converted->isNull();
+        if (column.role == TargetColumn::DIMENSION)
+        {
+            DimensionDesc const& dim = _dims[column.index];
+            if (!valid || converted->getInt64() < dim.getStartMin() || converted->getInt64() > dim.getEndMax())
+            {
+                _rejected = true;
+                return;
+            }
+            _cell[column.index] = converted->getInt64();
+            return;
+        }
+        Value& value = _values[column.index];
+        if (_attrTypes[column.index] == TE_STRING)
+        {
+            FieldConverter::unquote(start, end, _quote, _unquoted);
+            value.setSize<Value::IGNORE_DATA>(end - start + 1);
+            char* d = value.getData<char>();
+            memcpy(d, start, end-start);
+            d[(end-start)]=0;
+        }
+        else if (valid)
+        {
+            value = *converted;
         }
         else
         {
-            _errorBufVal.setNull();
+            _rejected = !_attrNullable[column.index];
         }
-        if(_splitOnDimension)
+    }
+
+    void endLine()
+    {
+        if (_rejected || _column != _columns.size())
         {
-            _outputChunkIterators[0] -> setPosition(_outputPosition);
-            _outputChunkIterators[0] -> writeItem(_errorBufVal);
-            _outputPosition[3] = 0;
+            ++_rejectedLines;
         }
         else
         {
-            _outputChunkIterators[_outputLineSize - 1] -> setPosition(_outputPosition);
-            _outputChunkIterators[_outputLineSize - 1] -> writeItem(_errorBufVal);
+            for (size_t i = 0; i < _dims.size(); ++i)
+            {
+                DimensionDesc const& dim = _dims[i];
+                _chunkPosition[i] = dim.getStartMin() + (_cell[i] - dim.getStartMin()) / dim.getChunkInterval() * dim.getChunkInterval();
+            }
+            Bucket& bucket = _buckets[_chunkPosition];
+            bucket.coordinates.insert(bucket.coordinates.end(), _cell.begin(), _cell.end());
+            _bufferedBytes += _cell.size() * sizeof(Coordinate);
+            for (Value& value : _values)
+            {
+                _bufferedBytes += sizeof(Value) + value.size();
+                bucket.values.push_back(std::move(value));
+            }
+            if (_bufferedBytes >= MAX_BUFFERED_BYTES)
+            {
+                spill();
+            }
         }
-        ++(_outputPosition[0]);
-        _outputColumn = 0;
+        resetLine();
     }
 
-    shared_ptr<Array> finalize()
+    /**
+     * Add the lines that were dropped here to the stats, as errors.
+     */
+    void countLines(AioInputStats& stats) const
     {
-        for(AttributeID i =0; i<_numLiveAttributes; ++i)
+        stats.errorLines += _rejectedLines;
+        stats.skippedLines += _rejectedLines;
+    }
+
+    /**
+     * Write the cells of all writers into a MemArray, one chunk per target
+     * chunk, in row-major order within each chunk. Each chunk is gathered
+     * from the spills and the buckets of the writers in turn, and of cells
+     * at the same position, the one gathered last is kept: within a writer,
+     * the one loaded last. The buckets are freed as they are written, and
+     * the spills at the end.
+     */
+    static shared_ptr<Array> finalize(vector<AIOTargetWriter*> const& writers, shared_ptr<Query>& query)
+    {
+        ArrayDesc const& schema = writers[0]->_schema;
+        shared_ptr<Array> output = std::make_shared<MemArray>(schema, query);
+        vector<shared_ptr<ArrayIterator> > arrayIterators;
+        for (const auto& attr : schema.getAttributes(/*excludeEbm:*/true))
         {
-            if(_outputChunkIterators[i].get())
+            arrayIterators.push_back(output->getIterator(attr));
+        }
+        std::set<Coordinates> chunkPositions;
+        for (AIOTargetWriter* writer : writers)
+        {
+            for (auto const& entry : writer->_spilled)
             {
-                _outputChunkIterators[i]->flush();
+                chunkPositions.insert(entry.first);
+            }
+            for (auto const& entry : writer->_buckets)
+            {
+                chunkPositions.insert(entry.first);
             }
-            _outputChunkIterators[i].reset();
-            _outputArrayIterators[i].reset();
         }
-        return _output;
+        Bucket gathered;
+        for (Coordinates const& chunkPosition : chunkPositions)
+        {
+            for (AIOTargetWriter* writer : writers)
+            {
+                writer->gather(chunkPosition, gathered);
+            }
+            writers[0]->writeBucket(gathered, chunkPosition, arrayIterators, nullptr, query);
+            gathered = Bucket();
+        }
+        for (AIOTargetWriter* writer : writers)
+        {
+            writer->_spilled.clear();
+            writer->_spillIterators.clear();
+            writer->_spill.reset();
+        }
+        return output;
+    }
+
+private:
+    void resetLine()
+    {
+        _column = 0;
+        _rejected = false;
+        for (Value& value : _values)
+        {
+            value.setNull();
+        }
+    }
+
+    /**
+     * Write every bucket to a chunk of the spill array of its own, at the
+     * target chunk's position and the number of this spill, and empty them.
+     */
+    void spill()
+    {
+        shared_ptr<Query> query(Query::getValidQueryPtr(_query));
+        if (!_spill)
+        {
+            Attributes attributes;
+            for (const auto& attr : _schema.getAttributes(/*excludeEbm:*/true))
+            {
+                attributes.push_back(AttributeDesc(attr.getName(), attr.getType(),
+                                                   attr.isNullable() ? AttributeDesc::IS_NULLABLE : 0,
+                                                   CompressorType::NONE));
+            }
+            attributes.addEmptyTagAttribute();
+            Dimensions dimensions;
+            for (DimensionDesc const& dim : _dims)
+            {
+                dimensions.push_back(DimensionDesc(dim.getBaseName(), dim.getStartMin(), dim.getStartMin(), dim.getEndMax(),
+                                                   dim.getEndMax(), dim.getChunkInterval(), 0));
+            }
+            dimensions.push_back(DimensionDesc("aio_spill_no", 0, 0, CoordinateBounds::getMax(), CoordinateBounds::getMax(), 1, 0));
+            ArrayDesc const spillSchema("aio_input_spill", attributes, dimensions, createDistribution(dtUndefined),
+                                        query->getDefaultArrayResidency());
+            _spill = std::make_shared<MemArray>(spillSchema, query);
+            for (const auto& attr : spillSchema.getAttributes(/*excludeEbm:*/true))
+            {
+                _spillIterators.push_back(_spill->getIterator(attr));
+            }
+        }
+        Coordinates spillChunk;
+        for (auto& entry : _buckets)
+        {
+            spillChunk = entry.first;
+            spillChunk.push_back(_numSpills);
+            writeBucket(entry.second, spillChunk, _spillIterators, &_numSpills, query);
+            _spilled[entry.first].push_back(_numSpills);
+        }
+        _buckets.clear();
+        _bufferedBytes = 0;
+        ++_numSpills;
+    }
+
+    /**
+     * Append the cells this writer has for the target chunk at chunkPosition
+     * to bucket, those spilled first, and drop its own bucket for it.
+     */
+    void gather(Coordinates const& chunkPosition, Bucket& bucket)
+    {
+        size_t const nDims = _dims.size();
+        size_t const nAttrs = _attrTypes.size();
+        auto spilled = _spilled.find(chunkPosition);
+        if (spilled != _spilled.end())
+        {
+            Coordinates spillChunk(chunkPosition);
+            spillChunk.push_back(0);
+            vector<AttributeDesc> attrs(_spill->getArrayDesc().getAttributes(true).begin(),
+                                        _spill->getArrayDesc().getAttributes(true).end());
+            for (Coordinate spillNo : spilled->second)
+            {
+                spillChunk.back() = spillNo;
+                size_t const firstCell = bucket.coordinates.size() / nDims;
+                for (size_t a = 0; a < nAttrs; ++a)
+                {
+                    shared_ptr<ConstArrayIterator> arrayIterator = _spill->getConstIterator(attrs[a]);
+                    if (!arrayIterator->setPosition(spillChunk))
+                    {
+                        throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "[defensive] aio_input lost a spilled chunk";
+                    }
+                    size_t cell = firstCell;
+                    for (shared_ptr<ConstChunkIterator> chunkIterator = arrayIterator->getChunk().getConstIterator(ConstChunkIterator::IGNORE_OVERLAPS);
+                         !chunkIterator->end(); ++(*chunkIterator), ++cell)
+                    {
+                        if (a == 0)
+                        {
+                            Coordinates const& position = chunkIterator->getPosition();
+                            bucket.coordinates.insert(bucket.coordinates.end(), position.begin(), position.begin() + nDims);
+                            bucket.values.resize(bucket.values.size() + nAttrs);
+                        }
+                        bucket.values[cell * nAttrs + a] = chunkIterator->getItem();
+                    }
+                }
+            }
+            _spilled.erase(spilled);
+        }
+        auto buffered = _buckets.find(chunkPosition);
+        if (buffered != _buckets.end())
+        {
+            Bucket& cells = buffered->second;
+            bucket.coordinates.insert(bucket.coordinates.end(), cells.coordinates.begin(), cells.coordinates.end());
+            std::move(cells.values.begin(), cells.values.end(), std::back_inserter(bucket.values));
+            _buckets.erase(buffered);
+        }
+    }
+
+    /**
+     * Write the cells of bucket into a new chunk of each of arrayIterators,
+     * at chunkPosition, in row-major order; of cells at the same position,
+     * the last is kept.
+     *
+     * @param spillNo If not null, the coordinate to add to every cell's
+     *    position, for the spill array's extra dimension.
+     */
+    void writeBucket(Bucket& bucket, Coordinates const& chunkPosition,
+                     vector<shared_ptr<ArrayIterator> >& arrayIterators,
+                     Coordinate const* spillNo, shared_ptr<Query>& query) const
+    {
+        size_t const nDims = _dims.size();
+        size_t const nAttrs = _attrTypes.size();
+        Coordinate const* coords = bucket.coordinates.data();
+        size_t const numCells = bucket.coordinates.size() / nDims;
+        vector<size_t> order(numCells);
+        for (size_t i = 0; i < numCells; ++i)
+        {
+            order[i] = i;
+        }
+        auto samePosition = [coords, nDims](size_t a, size_t b) {
+            return std::equal(coords + a * nDims, coords + (a + 1) * nDims, coords + b * nDims);
+        };
+        std::stable_sort(order.begin(), order.end(), [coords, nDims](size_t a, size_t b) {
+            return std::lexicographical_compare(coords + a * nDims, coords + (a + 1) * nDims,
+                                                coords + b * nDims, coords + (b + 1) * nDims);
+        });
+        Coordinates position(nDims + (spillNo ? 1 : 0));
+        if (spillNo)
+        {
+            position.back() = *spillNo;
+        }
+        for (size_t a = 0; a < nAttrs; ++a)
+        {
+            shared_ptr<ChunkIterator> chunkIterator = arrayIterators[a]->newChunk(chunkPosition).getIterator(query,
+                a == 0 ? ChunkIterator::SEQUENTIAL_WRITE : ChunkIterator::SEQUENTIAL_WRITE | ChunkIterator::NO_EMPTY_CHECK);
+            for (size_t k = 0; k < numCells; ++k)
+            {
+                size_t const cell = order[k];
+                if (k + 1 < numCells && samePosition(cell, order[k + 1]))
+                {
+                    continue;
+                }
+                std::copy(coords + cell * nDims, coords + (cell + 1) * nDims, position.begin());
+                chunkIterator->setPosition(position);
+                chunkIterator->writeItem(bucket.values[cell * nAttrs + a]);
+            }
+            chunkIterator->flush();
+        }
+        bucket = Bucket();
     }
 };
 
 /**
- * Class AIOOutputCache
- *
- * Tracks all of the pieces of the input buffer that make up the chunks
- * written for any given line in the input file.  Allows us to know
- * before we write any chunks for a line of the input if that line has
- * an error that would cause the 'error' attribute not to be null.
+ * Class AIOInferWriter
  *
- * Assumes that the lifetime of the buffer read from the file is longer
- * than the lifetime of this object.
+ * Takes the same calls as AIOOutputWriter, but keeps statistics on every
+ * column instead of writing its values: how many are empty, how many parse
+ * as a boolean, an integer or a number, the range of the integers, the
+ * longest value, and a HyperLogLog sketch of the distinct values. finalize
+ * combines the statistics of all instances into one cell per column.
  */
-class AIOOutputCache
+class AIOInferWriter : public boost::noncopyable
 {
 private:
-    size_t const _outputLineSize;
-    size_t _outputColumn;
-    AioInputSettings::Skip _skip;
-    bool _hasError{false};
+    static size_t const SKETCH_BITS = 12;
+    static size_t const SKETCH_SIZE = size_t(1) << SKETCH_BITS;
+
+    // The counts kept for each column.
+    enum Count { VALUES, BOOLS, INTEGERS, NUMBERS, NUM_COUNTS };
 
-    // An operation on the output array based-on the input data.
-    struct Operation
+    size_t const _numColumns;
+    char const _quote;
+    size_t _column;
+    vector<uint64_t> _counts;    // the lines seen, then NUM_COUNTS per column
+    vector<int64_t> _minimums;   // the smallest integer of each column
+    vector<int64_t> _maximums;   // the largest integer of each column, then the longest value
+    vector<uint8_t> _sketches;   // SKETCH_SIZE registers per column
+    Value _scratch;
+    string _unquoted;
+
+    /**
+     * @return the narrowest type that converts the most values of a column,
+     *    or string if none converts a majority of them.
+     * @param[out] failures The number of values that type does not convert.
+     */
+    static TypeId inferType(uint64_t const* counts, int64_t low, int64_t high, uint64_t& failures)
     {
-        enum class Type
+        uint64_t const values = counts[VALUES];
+        uint64_t const boolFailures = values - counts[BOOLS];
+        uint64_t const integerFailures = values - counts[INTEGERS];
+        uint64_t const numberFailures = values - counts[NUMBERS];
+        failures = std::min({boolFailures, integerFailures, numberFailures});
+        if (values == 0 || failures * 2 >= values)
         {
-            NONE,
-            NEW_CHUNK,   // corresponds to AIOOutputWriter::newChunk
-            WRITE_VALUE, // corresponds to AIOOutputWriter::writeValue
-            END_LINE     // corresponds to AIOOutputWriter::endLine
-        };
-
-        Operation(Type type,
-                  Coordinates const* inputChunkPos,
-                  char const* start,
-                  char const* end)
-                : _type(type)
-                , _inputChunkPosition(nullptr)
-                , _start(start)
-                , _end(end)
+            failures = 0;
+            return TID_STRING;
+        }
+        if (failures == boolFailures)
         {
-            if (inputChunkPos) {
-                _inputChunkPosition = std::make_shared<Coordinates>(*inputChunkPos);
+            return TID_BOOL;
+        }
+        if (failures == integerFailures)
+        {
+            if (low >= std::numeric_limits<int8_t>::min() && high <= std::numeric_limits<int8_t>::max())
+            {
+                return TID_INT8;
+            }
+            if (low >= std::numeric_limits<int16_t>::min() && high <= std::numeric_limits<int16_t>::max())
+            {
+                return TID_INT16;
+            }
+            if (low >= std::numeric_limits<int32_t>::min() && high <= std::numeric_limits<int32_t>::max())
+            {
+                return TID_INT32;
             }
+            return TID_INT64;
         }
+        return TID_DOUBLE;
+    }
 
-        Type _type{Type::NONE};
-        std::shared_ptr<Coordinates> _inputChunkPosition;
-        const char* _start{nullptr};
-        const char* _end{nullptr};
-    };
-
-    // All of the AIOOutputWriter operations that would've been done
-    // inline while reading the input file are instead remembered here,
-    // then inspected before any writing to the output array chunks takes
-    // place, allowing the 'skip' parameter to have its effect if configured.
-    using Operations = std::vector<Operation>;
-    Operations _operations;
-    Operations _currLine;
+    /**
+     * @return the HyperLogLog estimate of the number of distinct values added
+     *    to registers, with the usual corrections at both ends of the range.
+     */
+    static double estimateDistinct(uint8_t const* registers)
+    {
+        double const m = SKETCH_SIZE;
+        double const range = 4294967296.0;
+        double sum = 0;
+        size_t zeros = 0;
+        for (size_t i = 0; i < SKETCH_SIZE; ++i)
+        {
+            sum += std::ldexp(1.0, -registers[i]);
+            zeros += (registers[i] == 0);
+        }
+        double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        if (estimate <= 2.5 * m && zeros > 0)
+        {
+            estimate = m * std::log(m / zeros);
+        }
+        else if (estimate > range / 30)
+        {
+            estimate = -range * std::log(1 - estimate / range);
+        }
+        return estimate;
+    }
 
 public:
-    AIOOutputCache(ArrayDesc const& schema,
-                   shared_ptr<Query>& query,
-                   bool splitOnDimension,
-                   AioInputSettings::Skip skip)
-        : _outputLineSize(splitOnDimension ?
-                          schema.getDimensions()[3].getChunkInterval() :
-                          schema.getAttributes(true).size())
-        , _outputColumn(0)
-        , _skip(skip)
-        , _operations()
-        , _currLine()
-    { }
+    AIOInferWriter(size_t numColumns, char quote):
+        _numColumns(numColumns),
+        _quote(quote),
+        _column(0),
+        _counts(1 + numColumns * NUM_COUNTS, 0),
+        _minimums(numColumns, std::numeric_limits<int64_t>::max()),
+        _maximums(2 * numColumns, std::numeric_limits<int64_t>::min()),
+        _sketches(numColumns * SKETCH_SIZE, 0)
+    {}
+
+    void newChunk(Coordinates const& inputChunkPosition, shared_ptr<Query>& query)
+    {}
+
+    // Nothing is converted in the cache for aio_infer: converted is null.
+    void writeValue(char const* start, char const* end, Value const* converted, bool failed)
+    {
+        if (_column >= _numColumns)
+        {
+            return;
+        }
+        size_t const column = _column++;
+        FieldConverter::unquote(start, end, _quote, _unquoted);
+        if (start == end)
+        {
+            return;
+        }
+        uint64_t* counts = &_counts[1 + column * NUM_COUNTS];
+        ++counts[VALUES];
+        int64_t& longest = _maximums[_numColumns + column];
+        longest = std::max<int64_t>(longest, end - start);
+        int64_t integer;
+        double number;
+        if (FieldConverter::parseInt64(start, end, integer))
+        {
+            ++counts[INTEGERS];
+            ++counts[NUMBERS];
+            // "0" and "1" are bools as well
+            if (end - start == 1 && (integer == 0 || integer == 1))
+            {
+                ++counts[BOOLS];
+            }
+            _minimums[column] = std::min(_minimums[column], integer);
+            _maximums[column] = std::max(_maximums[column], integer);
+        }
+        else if (FieldConverter::parseDouble(start, end, number))
+        {
+            ++counts[NUMBERS];
+        }
+        else if (FieldConverter::convert(TE_BOOL, start, end, _scratch))
+        {
+            ++counts[BOOLS];
+        }
+        // The leading bits of the hash pick a register, which keeps the
+        // longest run of leading zeros seen in the rest.
+        uint32_t hash;
+        MurmurHash3_x86_32(start, (int) (end - start), 0, &hash);
+        uint32_t const rest = hash << SKETCH_BITS;
+        uint8_t const rank = rest == 0 ? 32 - SKETCH_BITS + 1 : __builtin_clz(rest) + 1;
+        uint8_t& reg = _sketches[column * SKETCH_SIZE + (hash >> (32 - SKETCH_BITS))];
+        reg = std::max(reg, rank);
+    }
+
+    void endLine()
+    {
+        ++_counts[0];
+        _column = 0;
+    }
 
     /**
-     * This duplicates the initialization and setup of the AIOOutputWriter::newChunk
-     * method but without committing anything to the output chunks.
-     *
-     * @param inputChunkPosition The upper left corner of the input chunk.
-     * @param query The query.
+     * Add the statistics of other to these.
      */
-    void newChunk(Coordinates const& inputChunkPosition, shared_ptr<Query>& query)
+    void absorb(AIOInferWriter const& other)
     {
-        _operations.emplace_back(Operation::Type::NEW_CHUNK, &inputChunkPosition, nullptr, nullptr);
+        for (size_t i = 0; i < _counts.size(); ++i)
+        {
+            _counts[i] += other._counts[i];
+        }
+        for (size_t i = 0; i < _minimums.size(); ++i)
+        {
+            _minimums[i] = std::min(_minimums[i], other._minimums[i]);
+        }
+        for (size_t i = 0; i < _maximums.size(); ++i)
+        {
+            _maximums[i] = std::max(_maximums[i], other._maximums[i]);
+        }
+        for (size_t i = 0; i < _sketches.size(); ++i)
+        {
+            _sketches[i] = std::max(_sketches[i], other._sketches[i]);
+        }
     }
 
     /**
-     * This duplicates the column and offset math of the AIOOutputWriter::writeValue
-     * method but without committing anything to the output chunks, allowing us to
-     * know if there would be an error at this line before writing to the output array.
-     *
-     * @param start A pointer to the start of a memory region containing the value
-     *    to write to the next output chunk.
-     * @param end  A pointer to the end of the memory region containing the value
-     *    to write to the next output chunk.
+     * Combine the statistics of all instances and write them, on instance
+     * 0, as one cell per column of schema: the inferred type, the longest
+     * value, the shares of empty values and of values the type does not
+     * convert, and the estimated number of distinct values.
      */
-    void writeValue(char const* start, char const* end)
+    shared_ptr<Array> finalize(ArrayDesc const& schema, shared_ptr<Query>& query)
     {
-        if (_outputColumn >= _outputLineSize - 1) {
-            _hasError = true;
+        allReduce(_counts, [](uint64_t a, uint64_t b) { return a + b; }, query);
+        allReduce(_minimums, [](int64_t a, int64_t b) { return std::min(a, b); }, query);
+        allReduce(_maximums, [](int64_t a, int64_t b) { return std::max(a, b); }, query);
+        allReduce(_sketches, [](uint8_t a, uint8_t b) { return std::max(a, b); }, query);
+        shared_ptr<Array> output = std::make_shared<MemArray>(schema, query);
+        if (query->getInstanceID() != 0)
+        {
+            return output;
+        }
+        uint64_t const lines = _counts[0];
+        vector<Value> type(_numColumns), maxLength(_numColumns), nullRatio(_numColumns),
+                      failureRatio(_numColumns), distinct(_numColumns);
+        for (size_t c = 0; c < _numColumns; ++c)
+        {
+            uint64_t const* counts = &_counts[1 + c * NUM_COUNTS];
+            uint64_t failures;
+            type[c].setString(inferType(counts, _minimums[c], _maximums[c], failures));
+            maxLength[c].setInt64(counts[VALUES] ? _maximums[_numColumns + c] : 0);
+            nullRatio[c].setDouble(lines ? double(lines - counts[VALUES]) / lines : 0);
+            failureRatio[c].setDouble(counts[VALUES] ? double(failures) / counts[VALUES] : 0);
+            distinct[c].setInt64(std::llround(estimateDistinct(&_sketches[c * SKETCH_SIZE])));
+        }
+        vector<Value> const* columns[] = { &type, &maxLength, &nullRatio, &failureRatio, &distinct };
+        Coordinates position(1, 0);
+        size_t a = 0;
+        for (const auto& attr : schema.getAttributes(/*excludeEbm:*/true))
+        {
+            shared_ptr<ChunkIterator> chunkIterator = output->getIterator(attr)->newChunk(position).getIterator(query,
+                a == 0 ? ChunkIterator::SEQUENTIAL_WRITE : ChunkIterator::SEQUENTIAL_WRITE | ChunkIterator::NO_EMPTY_CHECK);
+            for (size_t c = 0; c < _numColumns; ++c)
+            {
+                position[0] = c;
+                chunkIterator->setPosition(position);
+                chunkIterator->writeItem((*columns[a])[c]);
+            }
+            chunkIterator->flush();
+            position[0] = 0;
+            ++a;
         }
+        return output;
+    }
+};
 
-        ++_outputColumn;
+/**
+ * What one parsing thread writes to: a cache and a writer with an output of
+ * its own, so that threads share no chunk or iterator state. The writer is
+ * an AIOOutputWriter, an AIOTargetWriter when loading into a target, or an
+ * AIOInferWriter for aio_infer.
+ */
+struct AIOParseWorker
+{
+    std::unique_ptr<AIOOutputWriter> writer;
+    std::unique_ptr<AIOTargetWriter> targetWriter;
+    std::unique_ptr<AIOInferWriter> inferWriter;
+    AIOOutputCache cache;
 
-        _currLine.emplace_back(Operation::Type::WRITE_VALUE, nullptr, start, end);
+    AIOParseWorker(ArrayDesc const& schema, shared_ptr<Query>& query, AioInputSettings const& settings, bool infer = false):
+        cache(numColumns(schema, settings), infer ? vector<TypeEnum>() : columnTypes(schema, settings), settings.getSkip(),
+              settings.getQuote(), settings.getPredicates())
+    {
+        if (infer)
+        {
+            inferWriter.reset(new AIOInferWriter(settings.getNumAttributes(), settings.getQuote()));
+        }
+        else if (settings.hasTarget())
+        {
+            targetWriter.reset(new AIOTargetWriter(schema, settings.getTargetColumns(), settings.getQuote(), query));
+        }
+        else
+        {
+            writer.reset(new AIOOutputWriter(schema, query, settings.getSplitOnDimension(), settings.getAttributeDelimiter(), settings.getQuote(),
+                                             settings.getColumnAttributes()));
+        }
     }
 
     /**
-     * This duplicates the column and offset math of the AIOOutputWriter::endLine
-     * method but without committing anything to the output chunks, allowing us to
-     * know if there would be an error at this line before writing to the output array.
+     * Play the lines cached for the current block into the writer.
      */
-    void endLine()
+    void playback(shared_ptr<Query>& query)
     {
-        if (_outputColumn < _outputLineSize - 1) {
-            _hasError = true;
+        if (targetWriter)
+        {
+            cache.playback(query, *targetWriter);
         }
+        else if (inferWriter)
+        {
+            cache.playback(query, *inferWriter);
+        }
+        else
+        {
+            cache.playback(query, *writer);
+        }
+    }
 
-        _outputColumn = 0;
-
-        _currLine.emplace_back(Operation::Type::END_LINE, nullptr, nullptr, nullptr);
+private:
+    static size_t numColumns(ArrayDesc const& schema, AioInputSettings const& settings)
+    {
+        return settings.getNumAttributes();
+    }
 
-        // endLine() is called only once per line of input.  If there's an
-        // error at this point, then depending on the 'skip' parameter,
-        // delete this line from the cache.  When the cache is replayed later
-        // to write the chunks to the output array, the deleted line won't appear
-        // in the output.
-        if ((_skip == AioInputSettings::Skip::ERRORS && _hasError)
-            || (_skip == AioInputSettings::Skip::NON_ERRORS && !_hasError)) {
-            _currLine.clear();
+    static vector<TypeEnum> columnTypes(ArrayDesc const& schema, AioInputSettings const& settings)
+    {
+        if (settings.hasTarget())
+        {
+            return AIOTargetWriter::columnTypes(schema, settings.getTargetColumns());
+        }
+        if (settings.getSplitOnDimension())
+        {
+            return vector<TypeEnum>();
         }
-        else {
-            _operations.insert(_operations.end(),
-                               _currLine.begin(),
-                               _currLine.end());
-            _currLine.clear();
+        vector<size_t> const columnAttributes = settings.getColumnAttributes();
+        vector<TypeEnum> const attributeTypes = FieldConverter::attributeTypes(schema, schema.getAttributes(true).size() - 1);
+        vector<TypeEnum> types;
+        for (size_t attr : columnAttributes)
+        {
+            types.push_back(attr == AioInputSettings::NO_ATTRIBUTE ? TE_STRING : attributeTypes[attr]);
         }
-        _hasError = false;
+        return types;
     }
+};
+
+/**
+ * Runs a function on SciDB's job queue for operators, whose threads carry
+ * the query's context, keeping any exception it throws for the caller.
+ */
+class AIOParseJob : public Job
+{
+private:
+    std::function<void()> const _work;
+    std::exception_ptr          _error;
+
+public:
+    AIOParseJob(shared_ptr<Query> const& query, std::function<void()> const& work):
+        Job(query, std::string("AIOParseJob")),
+        _work(work)
+    {}
 
     /**
-     * Playback all of the operations recorded while processing the lines
-     * from the input chunk of the file, modulo any dropped lines due to
-     * an error, depending on the 'skip' parameter.
-     *
-     * @param query The query.
-     * @param writer The instance of the AIOOutputWriter that owns the
-     *     output array and its chunks.
+     * Wait for the job to finish, and rethrow what the function threw.
      */
-    void playback(std::shared_ptr<Query> query,
-                  AIOOutputWriter& writer)
-    {
-        if (_operations.size() == 1) {
-            // Every line on this chunk had an error, and
-            // only the NEW_CHUNK operation remains
-            // for playback.  Don't execute it, because
-            // executing it would create a chunk that has
-            // nothing on it.
-            return;
+    void finish()
+    {
+        wait();
+        if (_error)
+        {
+            std::rethrow_exception(_error);
         }
+    }
 
-        for (auto& op : _operations) {
-            switch (op._type) {
-            case Operation::Type::NEW_CHUNK:
-                writer.newChunk(*op._inputChunkPosition, query);
-                break;
-            case Operation::Type::WRITE_VALUE:
-                writer.writeValue(op._start, op._end);
-                break;
-            case Operation::Type::END_LINE:
-                writer.endLine();
-                break;
-            case Operation::Type::NONE:
-                // fall-through to default
-            default:
-                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION)
-                    << "Invalid operation type 'NONE' during aio_input()";
-                break;  // unreachable
-            }
+protected:
+    void run() override
+    {
+        try
+        {
+            _work();
+        }
+        catch (...)
+        {
+            _error = std::current_exception();
         }
-
-        _currLine.clear();
-        _operations.clear();
     }
 };
 
@@ -809,82 +4245,196 @@ public:
 
     void exchangeLastBlocks(vector<Coordinate> &myLastBlocks, shared_ptr<Query>& query)
     {
-        InstanceID const myId = query->getInstanceID();
-        size_t const numInstances = query->getInstancesCount();
-        size_t const vectorSize = numInstances *  sizeof(Coordinate);
-        shared_ptr<SharedBuffer> buf(new MemoryBuffer(SCIDB_CODE_LOC, &(myLastBlocks[0]), vectorSize));
-        for(InstanceID i = 0; i<numInstances; ++i)
+        allReduce(myLastBlocks, [](Coordinate a, Coordinate b) { return std::max(a, b); }, query);
+    }
+
+    /**
+     * Expand the paths of a distributing load into the files they name: a
+     * directory stands for the regular files directly inside it, a glob
+     * pattern for the regular files it matches.
+     *
+     * @return each file with its size in bytes.
+     */
+    static vector<pair<string, off_t> > expandInputPaths(vector<string> const& paths, Query const& query)
+    {
+        vector<pair<string, off_t> > files;
+        for (string const& path : paths)
         {
-            if (i == myId)
+            string const expanded = path::expandForRead(path, query);
+            vector<string> matches;
+            struct stat st;
+            if (stat(expanded.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
             {
-                continue;
+                DIR* dir = opendir(expanded.c_str());
+                if (dir != nullptr)
+                {
+                    while (dirent* entry = readdir(dir))
+                    {
+                        if (entry->d_name[0] != '.')
+                        {
+                            matches.push_back(expanded + "/" + entry->d_name);
+                        }
+                    }
+                    closedir(dir);
+                }
+                std::sort(matches.begin(), matches.end());
             }
-            BufSend(i, buf, query);
-        }
-        for(InstanceID i = 0; i<numInstances; ++i)
-        {
-            if (i == myId)
+            else
             {
-                continue;
+                glob_t globbed;
+                if (glob(expanded.c_str(), 0, nullptr, &globbed) == 0)
+                {
+                    matches.assign(globbed.gl_pathv, globbed.gl_pathv + globbed.gl_pathc);
+                }
+                globfree(&globbed);
             }
-            buf = BufReceive(i, query);
-            vector<Coordinate> otherLastBlocks(numInstances);
-            memcpy(&otherLastBlocks[0], buf->getConstData(), vectorSize);
-            for(size_t j =0; j<numInstances; ++j)
+            size_t const before = files.size();
+            for (string const& match : matches)
             {
-                if(otherLastBlocks[j] > myLastBlocks[j])
+                // FIFOs are taken as given; their size is unknown and counts as 0.
+                if (stat(match.c_str(), &st) == 0 && (S_ISREG(st.st_mode) || S_ISFIFO(st.st_mode)))
                 {
-                    myLastBlocks[j] = otherLastBlocks[j];
+                    files.push_back(std::make_pair(match, S_ISREG(st.st_mode) ? st.st_size : 0));
                 }
             }
+            if (files.size() == before)
+            {
+                ostringstream oss;
+                oss << "aio_input() path '" << path << "' names no files";
+                throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << oss.str().c_str();
+            }
         }
+        return files;
     }
 
-    shared_ptr< Array> execute(std::vector< shared_ptr< Array> >& inputArrays, shared_ptr<Query> query)
+    /**
+     * Spread files over numInstances readers with the longest-processing-time
+     * rule: largest file first, each to the reader with the fewest bytes so
+     * far. Ties go to firstInstance, then on in instance order, so a single
+     * file stays on firstInstance. Each reader keeps its files in the order
+     * they were given.
+     */
+    static vector<vector<string> > assignFiles(vector<pair<string, off_t> > const& files,
+                                               size_t numInstances,
+                                               InstanceID firstInstance)
     {
-        shared_ptr<AioInputSettings> settings (new AioInputSettings(_parameters, _kwParameters, false, query));
-        shared_ptr<Array> splitData;
-        if(settings->thisInstanceReadsData())
+        vector<size_t> order(files.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&files](size_t a, size_t b) {
+            return files[a].second > files[b].second;
+        });
+        vector<uint64_t> load(numInstances, 0);
+        vector<vector<size_t> > assigned(numInstances);
+        for (size_t f : order)
+        {
+            InstanceID best = firstInstance;
+            for (size_t k = 1; k < numInstances; ++k)
+            {
+                InstanceID const candidate = (firstInstance + k) % numInstances;
+                if (load[candidate] < load[best])
+                {
+                    best = candidate;
+                }
+            }
+            load[best] += files[f].second;
+            assigned[best].push_back(f);
+        }
+        vector<vector<string> > result(numInstances);
+        for (size_t i = 0; i < numInstances; ++i)
         {
-            splitData = shared_ptr<BinFileSplitArray>(new BinFileSplitArray(getSplitSchema(query), query, settings));
+            std::sort(assigned[i].begin(), assigned[i].end());
+            for (size_t f : assigned[i])
+            {
+                result[i].push_back(files[f].first);
+            }
+            LOG4CXX_DEBUG(logger, "aio_input instance " << i << " reads " << result[i].size() << " files, " << load[i] << " bytes");
+        }
+        return result;
+    }
+
+    /**
+     * For paths given without instances: the coordinator expands them into
+     * files and sends every instance its share, as a count followed by
+     * NUL-terminated paths.
+     */
+    void distributeInputFiles(AioInputSettings& settings, shared_ptr<Query>& query)
+    {
+        InstanceID const myId = query->getInstanceID();
+        size_t const numInstances = query->getInstancesCount();
+        if (query->isCoordinator())
+        {
+            vector<vector<string> > const shares =
+                assignFiles(expandInputPaths(settings.getInputPaths(), *query), numInstances, myId);
+            for (InstanceID i = 0; i < numInstances; ++i)
+            {
+                if (i == myId)
+                {
+                    continue;
+                }
+                uint64_t const count = shares[i].size();
+                string message((char const*) &count, sizeof(count));
+                for (string const& file : shares[i])
+                {
+                    message.append(file.c_str(), file.size() + 1);
+                }
+                shared_ptr<SharedBuffer> buf(new MemoryBuffer(SCIDB_CODE_LOC, message.data(), message.size()));
+                BufSend(i, buf, query);
+            }
+            settings.setInputFiles(shares[myId]);
         }
         else
         {
-            splitData = shared_ptr<BinEmptySinglePass>(new BinEmptySinglePass(getSplitSchema(query)));
+            shared_ptr<SharedBuffer> buf = BufReceive(query->getCoordinatorID(), query);
+            char const* data = (char const*) buf->getConstData();
+            uint64_t count;
+            memcpy(&count, data, sizeof(count));
+            data += sizeof(count);
+            vector<string> files;
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                files.push_back(string(data));
+                data += files.back().size() + 1;
+            }
+            settings.setInputFiles(files);
         }
+    }
 
-        splitData = redistributeToRandomAccess(splitData,
-                                               createDistribution(dtHashPartitioned),
-                                               ArrayResPtr(),
-                                               query,
-                                               shared_from_this());
+    /**
+     * Parse the block at inputIterator's position into the worker's writer,
+     * by way of its cache. The block becomes one output chunk of its own,
+     * unless loading into a target.
+     *
+     * @param supplementIter The ragged line ends to append to the blocks;
+     *    null for line_aligned blocks, which need none.
+     * @param lastBlocks The number of the last block of every reader.
+     */
+    void parseBlock(ConstArrayIterator& inputIterator,
+                    shared_ptr<ConstArrayIterator> const& supplementIter,
+                    vector<Coordinate> const& lastBlocks,
+                    AioInputSettings const& settings,
+                    AIOParseWorker& worker,
+                    shared_ptr<Query>& query)
+    {
+        AIOOutputCache& cache = worker.cache;
         size_t const nInstances = query->getInstancesCount();
-        vector<Coordinate> lastBlocks(nInstances, -1);
-        shared_ptr<Array> supplement = makeSupplement(splitData, query, settings, lastBlocks);
-        exchangeLastBlocks(lastBlocks, query);
-        supplement = redistributeToRandomAccess(supplement,
-                                                createDistribution(dtHashPartitioned),
-                                                ArrayResPtr(),
-                                                query,
-                                                shared_from_this());
-        shared_ptr<ConstArrayIterator> inputIterator = splitData->getConstIterator(getSplitSchema(query).getAttributes(true).firstDataAttribute());
-        shared_ptr<ConstArrayIterator> supplementIter = supplement->getConstIterator(getSplitSchema(query).getAttributes(true).firstDataAttribute());
+        bool const lineAligned = settings.getLineAligned();
         size_t const outputChunkSize = _schema.getDimensions()[0].getChunkInterval();
-        char const attDelim = settings->getAttributeDelimiter();
-        char const lineDelim = settings->getLineDelimiter();
-        AIOOutputWriter writer(_schema, query, settings->getSplitOnDimension(), settings->getAttributeDelimiter());
-        AIOOutputCache cache(_schema,
-                             query,
-                             settings->getSplitOnDimension(),
-                             settings->getSkip());
+        char const attDelim = settings.getAttributeDelimiter();
+        char const lineDelim = settings.getLineDelimiter();
+        char const quote = settings.getQuote();
+        bool const sampled = settings.isSampled();
+        uint64_t const sampleThreshold = settings.getSampleThreshold();
+        uint32_t const sampleSeed = settings.getSampleSeed();
         size_t const overheadSize = getChunkOverheadSize();
         size_t const sizeOffset = getSizeOffset();
-        while(!inputIterator-> end())
         {
-            Coordinates const& pos = inputIterator->getPosition();
+            Coordinates const& pos = inputIterator.getPosition();
             Coordinate const block = pos[0] * nInstances + pos[1];
-            bool const lastBlock = (lastBlocks[ pos[2] ] == block);
-            ConstChunk const& chunk =  inputIterator->getChunk();
+            bool const lastBlock = lineAligned || (lastBlocks[ pos[2] ] == block);
+            ConstChunk const& chunk =  inputIterator.getChunk();
             {
                 PinBuffer pinScope(chunk);
                 char* chunkData = ((char*) chunk.getConstData());
@@ -896,68 +4446,153 @@ public:
                     throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "[defensive] encountered a chunk with no data.";
                 }
                 size_t nLines =0;
-                if(pos[0] != 0 || pos[1] != pos[2])
+                // Tokenize [data, data+dataSize) into the cache. If lastSegment,
+                // a line delimiter ending the data ends the last line; otherwise
+                // it is followed by one more, empty, line.
+                auto countLine = [&]()
                 {
-                    while((*sourceStart)!=lineDelim)
+                    ++nLines;
+                    if (nLines > outputChunkSize)
                     {
-                        sourceStart ++;
+                        throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "Encountered a string with more lines than the chunk size; bailing";
                     }
-                    sourceStart ++;
-                    sourceSize = sourceSize - (sourceStart - chunkBodyStart);
-                }
-                bool haveSupplement = supplementIter->setPosition(pos);
-                vector<char>buf;
-                if(haveSupplement)
-                {
-                    shared_ptr<ConstChunkIterator> supplementChunkIterator = supplementIter->getChunk().getConstIterator();
-                    Value const &s = supplementChunkIterator->getItem();
-                    buf.resize(sourceSize+s.size());
-                    memcpy(&buf[0], sourceStart, sourceSize);
-                    memcpy(&buf[0]+ sourceSize, s.data(), s.size());
-                }
-                else
-                {
-                    buf.resize(sourceSize);
-                    memcpy(&buf[0], sourceStart, sourceSize);
-                }
-                if(lastBlock && buf.size() <= 1)
+                };
+                // As parseLines, but finding each whole line first: a line
+                // whose hash falls above the sample threshold is counted and
+                // passed over without being tokenized.
+                auto parseSampledLines = [&](const char* data, size_t dataSize, bool lastSegment)
                 {
-                    // Manually unpin before changing the iterator state, otherwise the PinBuffer's chunk
-                    // reference will dangle and cause a crash.
-                    pinScope.unPin();
-                    ++(*inputIterator);
-                    continue;
-                }
-                const char *data = &buf[0];
-                const char* start = data;
-                const char* end = start;
-                const char* terminus = start + buf.size();
-                bool finished = false;
-                cache.newChunk(pos, query);
-                while (!finished)
+                    const char* terminus = data + dataSize;
+                    DelimiterScanner lines(data, terminus, lineDelim, lineDelim, quote);
+                    cache.newSegment(data);
+                    const char* lineStart = data;
+                    while (true)
+                    {
+                        const char* lineEnd = lines.next();
+                        uint32_t hash;
+                        MurmurHash3_x86_32(lineStart, (int) (lineEnd - lineStart), sampleSeed, &hash);
+                        if (hash < sampleThreshold)
+                        {
+                            DelimiterScanner fields(lineStart, lineEnd, attDelim, attDelim, quote);
+                            const char* start = lineStart;
+                            while (true)
+                            {
+                                const char* end = fields.next();
+                                char const* valueEnd = end;
+                                if (quote && end == lineEnd && valueEnd != start && valueEnd[-1] == '\r')
+                                {
+                                    --valueEnd;
+                                }
+                                cache.writeValue(start, valueEnd);
+                                if (end == lineEnd)
+                                {
+                                    break;
+                                }
+                                start = end + 1;
+                            }
+                            cache.endLine();
+                        }
+                        else
+                        {
+                            cache.sampleOut();
+                        }
+                        countLine();
+                        if (lineEnd == terminus || (lastSegment && lineEnd == terminus - 1))
+                        {
+                            break;
+                        }
+                        lineStart = lineEnd + 1;
+                    }
+                };
+                auto parseLines = [&](const char* data, size_t dataSize, bool lastSegment)
                 {
-                    while( end != terminus && (*end)!=attDelim && (*end)!=lineDelim )
+                    if (sampled)
                     {
-                        ++end;
+                        parseSampledLines(data, dataSize, lastSegment);
+                        return;
                     }
-                    cache.writeValue(start, end);
-                    if(end == terminus || (*end) == lineDelim )
+                    const char* start = data;
+                    const char* end = start;
+                    const char* terminus = start + dataSize;
+                    DelimiterScanner scanner(data, terminus, attDelim, lineDelim, quote);
+                    cache.newSegment(data);
+                    bool finished = false;
+                    while (!finished)
                     {
-                        cache.endLine();
-                        ++nLines;
-                        if (nLines > outputChunkSize)
+                        end = scanner.next();
+                        char const* valueEnd = end;
+                        if (quote && valueEnd != start && valueEnd[-1] == '\r' && (end == terminus || *end == lineDelim))
+                        {
+                            // CSV lines may end in CRLF.
+                            --valueEnd;
+                        }
+                        cache.writeValue(start, valueEnd);
+                        if(end == terminus || (*end) == lineDelim )
+                        {
+                            cache.endLine();
+                            countLine();
+                            if(end == terminus || (lastSegment && end == terminus-1))
+                            {
+                                finished = true;
+                            }
+                        }
+                        if (end != terminus)
                         {
-                            throw SYSTEM_EXCEPTION(SCIDB_SE_INTERNAL, SCIDB_LE_ILLEGAL_OPERATION) << "Encountered a string with more lines than the chunk size; bailing";
+                            start = end+1;
                         }
-                        if(end == terminus || (lastBlock && end == terminus-1))
+                    }
+                };
+                // Only the line that runs from the end of this block into the
+                // supplement, the first line of the next block, is copied; the
+                // rest of the block is parsed where it lies in the chunk.
+                vector<char> spanningLine;
+                shared_ptr<ConstChunkIterator> supplementChunkIterator;
+                if(lineAligned)
+                {
+                    cache.newChunk(pos, query);
+                    parseLines(sourceStart, sourceSize, true);
+                }
+                else
+                {
+                    if(pos[0] != 0 || pos[1] != pos[2])
+                    {
+                        while((*sourceStart)!=lineDelim)
                         {
-                            finished = true;
+                            sourceStart ++;
                         }
+                        sourceStart ++;
+                        sourceSize = sourceSize - (sourceStart - chunkBodyStart);
+                    }
+                    Value const* supplement = nullptr;
+                    if(supplementIter->setPosition(pos))
+                    {
+                        supplementChunkIterator = supplementIter->getChunk().getConstIterator();
+                        supplement = &supplementChunkIterator->getItem();
                     }
-                    if (end != terminus)
+                    size_t const supplementSize = supplement ? supplement->size() : 0;
+                    if(lastBlock && sourceSize + supplementSize <= 1)
                     {
-                        start = end+1;
-                        end   = end+1;
+                        return;
+                    }
+                    cache.newChunk(pos, query);
+                    auto lastDelim = static_cast<const char*>(memrchr(sourceStart, lineDelim, sourceSize));
+                    size_t const inPlace = lastDelim ? lastDelim - sourceStart + 1 : 0;
+                    if(inPlace > 0)
+                    {
+                        parseLines(sourceStart, inPlace, true);
+                    }
+                    spanningLine.reserve(sourceSize - inPlace + supplementSize + 1);
+                    spanningLine.assign(sourceStart + inPlace, sourceStart + sourceSize);
+                    if(supplementSize > 0)
+                    {
+                        char const* supplementData = static_cast<char const*>(supplement->data());
+                        spanningLine.insert(spanningLine.end(), supplementData, supplementData + supplementSize);
+                    }
+                    if(!spanningLine.empty() || !lastBlock)
+                    {
+                        // Never empty storage, so that an empty last line has a valid address.
+                        spanningLine.push_back(0);
+                        parseLines(spanningLine.data(), spanningLine.size() - 1, lastBlock);
                     }
                 }
 
@@ -966,17 +4601,340 @@ public:
                 // the same order and with the same values as
                 // they would've been executed had the cache
                 // layer not been present.  This must be done
-                // here and before the buf buffer goes out-of-scope,
+                // here and before the chunk is unpinned and the
+                // spanningLine buffer goes out-of-scope,
                 // otherwise the recorded addresses will point to
                 // bogus data.
-                cache.playback(query, writer);
+                worker.playback(query);
+            }
+        }
+    }
+
+    /**
+     * Parse the redistributed blocks in splitData that landed on this
+     * instance. With one worker, the blocks are parsed in order on this
+     * thread; with more, the first worker runs on this thread and each of
+     * the others as a job on the operator job queue, and each takes the
+     * next unparsed block until none are left. Blocks map to distinct output
+     * chunks, so the workers never write to the same chunk. What they share
+     * is only read: splitData and supplement, which are fully materialized
+     * and, like any MemArray, pinned chunk by chunk through the thread-safe
+     * buffer cache; each worker has iterators and an output of its own.
+     * Since this thread parses too, the blocks get parsed even when the
+     * queue's threads are all busy.
+     *
+     * @param supplement The ragged line ends to append to the blocks; null
+     *    for line_aligned blocks, which need none.
+     * @param lastBlocks The number of the last block of every reader.
+     */
+    void parseBlocks(shared_ptr<Array> const& splitData,
+                     shared_ptr<Array> const& supplement,
+                     vector<Coordinate> const& lastBlocks,
+                     AioInputSettings const& settings,
+                     vector<std::unique_ptr<AIOParseWorker> >& workers,
+                     shared_ptr<Query>& query)
+    {
+        ArrayDesc const splitSchema = getSplitSchema(query);
+        AttributeDesc const& attr = splitSchema.getAttributes(true).firstDataAttribute();
+        if (workers.size() == 1)
+        {
+            shared_ptr<ConstArrayIterator> inputIterator = splitData->getConstIterator(attr);
+            shared_ptr<ConstArrayIterator> supplementIter;
+            if (supplement)
+            {
+                supplementIter = supplement->getConstIterator(attr);
+            }
+            while(!inputIterator->end())
+            {
+                parseBlock(*inputIterator, supplementIter, lastBlocks, settings, *workers[0], query);
+                ++(*inputIterator);
+            }
+            return;
+        }
+        vector<Coordinates> positions;
+        for (shared_ptr<ConstArrayIterator> iter = splitData->getConstIterator(attr); !iter->end(); ++(*iter))
+        {
+            positions.push_back(iter->getPosition());
+        }
+        std::atomic<size_t> next(0);
+        auto work = [&](size_t t)
+        {
+            try
+            {
+                shared_ptr<ConstArrayIterator> inputIterator = splitData->getConstIterator(attr);
+                shared_ptr<ConstArrayIterator> supplementIter;
+                if (supplement)
+                {
+                    supplementIter = supplement->getConstIterator(attr);
+                }
+                for (size_t i = next++; i < positions.size(); i = next++)
+                {
+                    inputIterator->setPosition(positions[i]);
+                    parseBlock(*inputIterator, supplementIter, lastBlocks, settings, *workers[t], query);
+                }
+            }
+            catch (...)
+            {
+                next = positions.size();
+                throw;
+            }
+        };
+        // Every job that was queued is waited for, whatever happens here,
+        // since they all use this frame.
+        vector<shared_ptr<AIOParseJob> > jobs;
+        jobs.reserve(workers.size());
+        std::exception_ptr error;
+        try
+        {
+            for (size_t t = 1; t < workers.size(); ++t)
+            {
+                shared_ptr<AIOParseJob> job = std::make_shared<AIOParseJob>(query, [&work, t]() { work(t); });
+                PhysicalOperator::getGlobalQueueForOperators()->pushJob(job);
+                jobs.push_back(job);
+            }
+            work(0);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        for (shared_ptr<AIOParseJob> const& job : jobs)
+        {
+            try
+            {
+                job->finish();
+            }
+            catch (...)
+            {
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     * Finish the workers' outputs and gather them into one array. Target
+     * cells are gathered from all workers chunk by chunk and written once.
+     * Otherwise a single worker's array is returned as is, or every chunk
+     * is copied into a fresh MemArray, each worker's writer, and with it its
+     * array, being released once its chunks are copied.
+     */
+    shared_ptr<Array> mergeOutputs(vector<std::unique_ptr<AIOParseWorker> >& workers, shared_ptr<Query>& query)
+    {
+        if (workers[0]->targetWriter)
+        {
+            vector<AIOTargetWriter*> writers;
+            for (std::unique_ptr<AIOParseWorker>& worker : workers)
+            {
+                writers.push_back(worker->targetWriter.get());
+            }
+            return AIOTargetWriter::finalize(writers, query);
+        }
+        if (workers.size() == 1)
+        {
+            return workers[0]->writer->finalize();
+        }
+        shared_ptr<Array> output = std::make_shared<MemArray>(_schema, query);
+        for (std::unique_ptr<AIOParseWorker>& worker : workers)
+        {
+            {
+                shared_ptr<Array> part = worker->writer->finalize();
+                for (auto const& attr : _schema.getAttributes())
+                {
+                    shared_ptr<ArrayIterator> outputIterator = output->getIterator(attr);
+                    for (shared_ptr<ConstArrayIterator> partIterator = part->getConstIterator(attr); !partIterator->end(); ++(*partIterator))
+                    {
+                        outputIterator->copyChunk(partIterator->getChunk());
+                    }
+                }
+            }
+            worker->writer.reset();
+        }
+        return output;
+    }
+
+    /**
+     * Read the input, send its blocks around the cluster and parse the ones
+     * that land on this instance into the workers.
+     */
+    void loadBlocks(shared_ptr<AioInputSettings>& settings,
+                    shared_ptr<AioInputStats> const& stats,
+                    vector<std::unique_ptr<AIOParseWorker> >& workers,
+                    shared_ptr<Query>& query)
+    {
+        if (settings->getStreamWindow() > 0)
+        {
+            streamBlocks(settings, stats, workers, query);
+        }
+        else
+        {
+            AioInputStats::Clock::time_point phaseStart = AioInputStats::Clock::now();
+            shared_ptr<Array> splitData;
+            if(settings->thisInstanceReadsData())
+            {
+                splitData = shared_ptr<BinFileSplitArray>(new BinFileSplitArray(getSplitSchema(query), query, settings, stats));
+            }
+            else
+            {
+                splitData = shared_ptr<BinEmptySinglePass>(new BinEmptySinglePass(getSplitSchema(query)));
+            }
+
+            splitData = redistributeToRandomAccess(splitData,
+                                                   createDistribution(dtHashPartitioned),
+                                                   ArrayResPtr(),
+                                                   query,
+                                                   shared_from_this());
+            stats->redistributeNanos = AioInputStats::nanosSince(phaseStart);
+            phaseStart = AioInputStats::Clock::now();
+            // With line_aligned, every block ends at a line boundary, so there
+            // are no ragged line ends to send on and blocks are parsed in place.
+            vector<Coordinate> lastBlocks(query->getInstancesCount(), -1);
+            shared_ptr<Array> supplement;
+            if (!settings->getLineAligned())
+            {
+                supplement = makeSupplement(splitData, query, settings, lastBlocks);
+                exchangeLastBlocks(lastBlocks, query);
+                supplement = redistributeToRandomAccess(supplement,
+                                                        createDistribution(dtHashPartitioned),
+                                                        ArrayResPtr(),
+                                                        query,
+                                                        shared_from_this());
+            }
+            stats->supplementNanos = AioInputStats::nanosSince(phaseStart);
+            phaseStart = AioInputStats::Clock::now();
+            parseBlocks(splitData, supplement, lastBlocks, *settings, workers, query);
+            stats->parseNanos = AioInputStats::nanosSince(phaseStart);
+        }
+    }
+
+    shared_ptr< Array> execute(std::vector< shared_ptr< Array> >& inputArrays, shared_ptr<Query> query)
+    {
+        shared_ptr<AioInputSettings> settings (new AioInputSettings(_parameters, _kwParameters, false, query));
+        if (settings->distributesPaths())
+        {
+            distributeInputFiles(*settings, query);
+        }
+        shared_ptr<AioInputStats> stats(new AioInputStats());
+        vector<std::unique_ptr<AIOParseWorker> > workers;
+        for (size_t i = 0; i < settings->getParseThreads(); ++i)
+        {
+            workers.emplace_back(new AIOParseWorker(_schema, query, *settings));
+        }
+        loadBlocks(settings, stats, workers, query);
+        shared_ptr<Array> result = mergeOutputs(workers, query);
+        for (std::unique_ptr<AIOParseWorker> const& worker : workers)
+        {
+            worker->cache.countLines(*stats);
+            if (worker->targetWriter)
+            {
+                worker->targetWriter->countLines(*stats);
+            }
+        }
+        stats->log(query->getInstanceID());
+        return result;
+    }
+
+    /**
+     * Load in waves of at most stream_window blocks per reading instance:
+     * each wave is redistributed, parsed and released before the next one
+     * is read, so memory use is bounded by the window rather than by the
+     * size of the input. The blocks are line-aligned, so each wave can be
+     * parsed without waiting for the next. All instances take part in every
+     * wave until no reader has input left.
+     */
+    void streamBlocks(shared_ptr<AioInputSettings> const& settings,
+                      shared_ptr<AioInputStats> const& stats,
+                      vector<std::unique_ptr<AIOParseWorker> >& workers,
+                      shared_ptr<Query>& query)
+    {
+        shared_ptr<BinFileSplitArray> source;
+        if (settings->thisInstanceReadsData())
+        {
+            source.reset(new BinFileSplitArray(getSplitSchema(query), query, settings, stats));
+        }
+        vector<Coordinate> const noLastBlocks;
+        size_t waves = 0;
+        bool moreInput = true;
+        while (moreInput)
+        {
+            AioInputStats::Clock::time_point phaseStart = AioInputStats::Clock::now();
+            shared_ptr<Array> wave;
+            if (source)
+            {
+                wave.reset(new BlockWaveArray(getSplitSchema(query), source, settings->getStreamWindow()));
+            }
+            else
+            {
+                wave.reset(new BinEmptySinglePass(getSplitSchema(query)));
             }
-            ++(*inputIterator);
+            wave = redistributeToRandomAccess(wave,
+                                              createDistribution(dtHashPartitioned),
+                                              ArrayResPtr(),
+                                              query,
+                                              shared_from_this());
+            stats->redistributeNanos += AioInputStats::nanosSince(phaseStart);
+            phaseStart = AioInputStats::Clock::now();
+            parseBlocks(wave, shared_ptr<Array>(), noLastBlocks, *settings, workers, query);
+            wave.reset();
+            stats->parseNanos += AioInputStats::nanosSince(phaseStart);
+            vector<uint8_t> more(1, source && source->hasMoreInput());
+            allReduce(more, [](uint8_t a, uint8_t b) { return (uint8_t) (a || b); }, query);
+            moreInput = more[0];
+            ++waves;
         }
-        return writer.finalize();
+        LOG4CXX_DEBUG(logger, "aio_input streamed in " << waves << " waves");
     }
 };
 
 REGISTER_PHYSICAL_OPERATOR_FACTORY(PhysicalAioInput, "aio_input", "PhysicalAioInput");
 
+/**
+ * aio_infer reads and parses its input exactly as aio_input does, but
+ * into per-column statistics rather than an array of the values.
+ */
+class PhysicalAioInfer : public PhysicalAioInput
+{
+public:
+    PhysicalAioInfer(std::string const& logicalName,
+                     std::string const& physicalName,
+                     Parameters const& parameters,
+                     ArrayDesc const& schema):
+        PhysicalAioInput(logicalName, physicalName, parameters, schema)
+    {}
+
+    shared_ptr< Array> execute(std::vector< shared_ptr< Array> >& inputArrays, shared_ptr<Query> query)
+    {
+        shared_ptr<AioInputSettings> settings (new AioInputSettings(_parameters, _kwParameters, false, query));
+        if (settings->distributesPaths())
+        {
+            distributeInputFiles(*settings, query);
+        }
+        shared_ptr<AioInputStats> stats(new AioInputStats());
+        vector<std::unique_ptr<AIOParseWorker> > workers;
+        for (size_t i = 0; i < settings->getParseThreads(); ++i)
+        {
+            workers.emplace_back(new AIOParseWorker(_schema, query, *settings, true));
+        }
+        loadBlocks(settings, stats, workers, query);
+        for (size_t i = 1; i < workers.size(); ++i)
+        {
+            workers[0]->inferWriter->absorb(*workers[i]->inferWriter);
+        }
+        for (std::unique_ptr<AIOParseWorker> const& worker : workers)
+        {
+            worker->cache.countLines(*stats);
+        }
+        stats->log(query->getInstanceID());
+        return workers[0]->inferWriter->finalize(_schema, query);
+    }
+};
+
+REGISTER_PHYSICAL_OPERATOR_FACTORY(PhysicalAioInfer, "aio_infer", "PhysicalAioInfer");
+
 } // end namespace scidb
@@ -68,6 +68,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/unordered_map.hpp>
 
+#include "AioCollectives.h"
 #include "AioSaveSettings.h"
 
 
@@ -1631,26 +1632,9 @@ public:
      */
     bool agreeOnBoolean(bool value, shared_ptr<Query>& query)
     {
-        std::shared_ptr<SharedBuffer> buf(new MemoryBuffer(SCIDB_CODE_LOC, NULL, sizeof(bool)));
-        InstanceID myId = query->getInstanceID();
-        *((bool*) buf->getWriteData()) = value;
-        for(InstanceID i=0; i<query->getInstancesCount(); i++)
-        {
-            if(i != myId)
-            {
-                BufSend(i, buf, query);
-            }
-        }
-        for(InstanceID i=0; i<query->getInstancesCount(); i++)
-        {
-            if(i != myId)
-            {
-                buf = BufReceive(i,query);
-                bool otherInstanceVal = *((bool*) buf->getConstData());
-                value = value && otherInstanceVal;
-            }
-        }
-        return value;
+        vector<uint8_t> values(1, value);
+        allReduce(values, [](uint8_t a, uint8_t b) { return (uint8_t) (a && b); }, query);
+        return values[0];
     }
 
     std::shared_ptr< Array> execute(std::vector< std::shared_ptr< Array> >& inputArrays, std::shared_ptr<Query> query)
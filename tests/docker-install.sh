@@ -12,7 +12,8 @@ BASEDIR=$(dirname $0)/..
 PYTHON=python3
 if [ "$id" = "CentOS" ]
 then
-    for pkg in centos-release-scl libpqxx-devel python3 cmake3
+    for pkg in centos-release-scl libpqxx-devel python3 cmake3 \
+               zlib-devel libzstd-devel lz4-devel zstd lz4
     do
         yum install --assumeyes $pkg
     done
@@ -45,6 +46,7 @@ else
     apt-get install --assume-yes --no-install-recommends        \
             libarrow-dev=$ARROW_VER-1                           \
             libpqxx-dev                                         \
+            zlib1g-dev libzstd-dev liblz4-dev zstd lz4          \
             python3.7
     PYTHON=python3.7
 fi
@@ -0,0 +1,442 @@
+#!/bin/bash
+
+set -o errexit
+
+DIR=`dirname $0`
+TEST_OUT=$DIR/test-read.out
+rm -f $TEST_OUT  # in case it exists from previous run
+
+# Append the description of the error the query fails with
+function iq_error() {
+    iquery -aq "$1" 2>&1 | grep "Error description" >> $TEST_OUT || true
+}
+
+# Append the number of lines, the sums of the two numeric columns and the
+# number of errors of big.tsv loaded with the aio_input parameters given
+function big_sums() {
+    iquery -otsv -aq "aggregate(apply(aio_input($1), v, dcast(a0, int64(null)), w, dcast(a1, int64(null))), count(*), sum(v), sum(w), count(error))" >> $TEST_OUT
+}
+
+# Append the number of instances that logged the line aio_input logs when
+# it finishes, and the totals over them of the bytes read and of the lines
+# parsed, with errors, skipped, filtered out and sampled out, for the query
+function log_totals() {
+    local base=`sed --quiet 's/^base-path *= *//p' /opt/scidb/*/etc/config.ini`
+    local logs=`ls $base/0/*/scidb.log`
+    local f
+    for f in $logs
+    do
+        wc --lines < $f
+    done > /tmp/load_tools_test/log-lines
+    iquery -otsv -aq "$1" >> $TEST_OUT
+    for f in $logs
+    do
+        read n
+        tail --lines=+$((n + 1)) $f
+    done < /tmp/load_tools_test/log-lines \
+        | sed --quiet 's/.*aio_input instance .* read \([0-9]*\) bytes .*, \([0-9]*\) lines, \([0-9]*\) with errors, \([0-9]*\) skipped, \([0-9]*\) filtered out, \([0-9]*\) sampled out.*/\1 \2 \3 \4 \5 \6/p' \
+        | awk '{ for (i = 1; i <= NF; i++) t[i] += $i; n++ } END { print n, t[1], t[2], t[3], t[4], t[5], t[6] }' >> $TEST_OUT
+}
+
+# Create test input files
+rm -rf /tmp/load_tools_test
+mkdir -p /tmp/load_tools_test
+# Compressible, and many times larger than the 1MB blocks compressed
+# input is decoded in
+seq 1 500000 | awk '{printf "%d\t%d\tthe quick brown fox jumps over the lazy dog\n", $1, $1 % 10}' \
+    > /tmp/load_tools_test/big.tsv
+
+# Block Reads: regular files are read with several blocks in flight, FIFOs
+# with select() and read(); the last size divides the file into 5 blocks
+echo "Block Reads" >> $TEST_OUT
+for b in 100000 5277779
+do
+    echo "buffer_size:$b" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, buffer_size:$b"
+done
+echo "FIFO" >> $TEST_OUT
+mkfifo /tmp/load_tools_test/big.fifo
+cat /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.fifo &
+big_sums "'/tmp/load_tools_test/big.fifo', num_attributes:3, buffer_size:100000"
+wait
+
+# mmap: blocks are cut out of the mapping; files that cannot be mapped, such
+# as FIFOs and empty files, are read as usual
+echo "mmap" >> $TEST_OUT
+for p in "buffer_size:100000" "header:1" "buffer_size:100000, line_aligned:true"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, mmap:true, $p"
+done
+echo "FIFO" >> $TEST_OUT
+cat /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.fifo &
+big_sums "'/tmp/load_tools_test/big.fifo', num_attributes:3, mmap:true"
+wait
+echo "empty file" >> $TEST_OUT
+touch /tmp/load_tools_test/empty.tsv
+iquery -otsv -aq "op_count(aio_input('/tmp/load_tools_test/empty.tsv', num_attributes:3, mmap:true))" >> $TEST_OUT
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, mmap:true, direct_io:true)"
+
+# parallel_read: every instance reads its own range of the file; the three
+# line file has fewer blocks than there are instances
+echo "parallel_read" >> $TEST_OUT
+for p in "buffer_size:8000000" "buffer_size:100000" "header:1, buffer_size:1000000"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, parallel_read:true, $p"
+done
+echo "three lines" >> $TEST_OUT
+head --lines=3 /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/three.tsv
+iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/three.tsv', num_attributes:3, parallel_read:true, buffer_size:64), v, dcast(a0, int64(null)), s, src_instance_id), count(*), sum(v), max(s))" >> $TEST_OUT
+gzip --stdout /tmp/load_tools_test/three.tsv > /tmp/load_tools_test/three.tsv.gz
+iq_error "aio_input('/tmp/load_tools_test/three.tsv.gz', num_attributes:3, parallel_read:true)"
+iq_error "aio_input(paths:('/tmp/load_tools_test/three.tsv','/tmp/load_tools_test/big.tsv'), num_attributes:3, parallel_read:true)"
+iq_error "aio_input('/tmp/load_tools_test/three.tsv', num_attributes:3, parallel_read:true, format:'csv')"
+iq_error "aio_input('/tmp/load_tools_test/three.tsv', num_attributes:3, parallel_read:true, line_aligned:true)"
+
+# direct_io: reads are aligned whatever the block size, header length and
+# file size; FIFOs, and filesystems without O_DIRECT, are read as usual
+echo "direct_io" >> $TEST_OUT
+for p in "buffer_size:100000" "buffer_size:1000003" "header:1, buffer_size:1000003"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, direct_io:true, $p"
+done
+echo "FIFO" >> $TEST_OUT
+cat /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.fifo &
+big_sums "'/tmp/load_tools_test/big.fifo', num_attributes:3, direct_io:true"
+wait
+
+# Compressed Input
+echo "Compressed Input" >> $TEST_OUT
+gzip --stdout /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.tsv.gz
+zstd --quiet --stdout /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.tsv.zst
+lz4 --quiet --stdout /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.tsv.lz4
+for f in big.tsv big.tsv.gz big.tsv.zst big.tsv.lz4
+do
+    echo "$f" >> $TEST_OUT
+    iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/$f', num_attributes:3), v, dcast(a0, int64(null)), w, dcast(a1, int64(null))), count(*), sum(v), sum(w), count(error))" >> $TEST_OUT
+done
+echo "two gzip members" >> $TEST_OUT
+cat /tmp/load_tools_test/big.tsv.gz /tmp/load_tools_test/big.tsv.gz > /tmp/load_tools_test/twice.tsv.gz
+iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/twice.tsv.gz', num_attributes:3), v, dcast(a0, int64(null))), count(*), sum(v))" >> $TEST_OUT
+echo "truncated gzip" >> $TEST_OUT
+head --bytes=100000 /tmp/load_tools_test/big.tsv.gz > /tmp/load_tools_test/truncated.tsv.gz
+iq_error "aggregate(aio_input('/tmp/load_tools_test/truncated.tsv.gz', num_attributes:3), count(*))"
+for f in big.tsv.gz big.tsv.zst big.tsv.lz4
+do
+    echo "$f header:1, buffer_size:100000" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/$f', num_attributes:3, header:1, buffer_size:100000"
+done
+echo "zstd FIFO" >> $TEST_OUT
+cat /tmp/load_tools_test/big.tsv.zst > /tmp/load_tools_test/big.fifo &
+big_sums "'/tmp/load_tools_test/big.fifo', num_attributes:3"
+wait
+
+# Directories and globs: the files are spread over the instances by size,
+# largest first; a directory skips hidden files, and each file its header
+echo "Directories and Globs" >> $TEST_OUT
+mkdir /tmp/load_tools_test/drop
+sed --quiet 1,100p /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/drop/a.tsv
+sed --quiet 101,1000p /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/drop/b.tsv
+sed --quiet 1001,100000p /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/drop/c.tsv
+# The last line of d.tsv has no line delimiter
+sed --quiet 100001,100002p /tmp/load_tools_test/big.tsv | head --bytes=-1 > /tmp/load_tools_test/drop/d.tsv
+head --lines=5 /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/drop/e.txt
+head --lines=5 /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/drop/.hidden.tsv
+echo "directory" >> $TEST_OUT
+big_sums "paths:'/tmp/load_tools_test/drop', num_attributes:3"
+iquery -otsv -aq "aggregate(aio_input(paths:'/tmp/load_tools_test/drop', num_attributes:3), count(*), src_instance_id)" >> $TEST_OUT
+echo "glob" >> $TEST_OUT
+big_sums "paths:'/tmp/load_tools_test/drop/*.tsv', num_attributes:3"
+echo "file and glob, header:1" >> $TEST_OUT
+big_sums "paths:('/tmp/load_tools_test/drop/a.tsv','/tmp/load_tools_test/drop/[bc].tsv'), num_attributes:3, header:1"
+iq_error "aio_input(paths:'/tmp/load_tools_test/drop/*.csv', num_attributes:3)"
+
+# read_ahead: a background thread reads blocks ahead; its errors still fail
+# the query
+echo "read_ahead" >> $TEST_OUT
+for p in "read_ahead:1" "read_ahead:4, buffer_size:100000" "read_ahead:64, buffer_size:100000, line_aligned:true"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, $p"
+done
+echo "FIFO" >> $TEST_OUT
+cat /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/big.fifo &
+big_sums "'/tmp/load_tools_test/big.fifo', num_attributes:3, read_ahead:4, buffer_size:100000"
+wait
+echo "directory" >> $TEST_OUT
+big_sums "paths:'/tmp/load_tools_test/drop', num_attributes:3, read_ahead:2, buffer_size:100000"
+iq_error "aggregate(aio_input('/tmp/load_tools_test/truncated.tsv.gz', num_attributes:3, read_ahead:2), count(*))"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, read_ahead:65)"
+
+# Telemetry: every instance logs what it read and parsed
+echo "Telemetry" >> $TEST_OUT
+head --lines=8 /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/telemetry.tsv
+printf '9\t9\n10\n' >> /tmp/load_tools_test/telemetry.tsv
+log_totals "op_count(aio_input('/tmp/load_tools_test/telemetry.tsv', num_attributes:3, skip:'errors'))"
+
+# line_aligned: blocks end at line ends, including blocks of exactly one line
+# and a last line without a line delimiter
+echo "line_aligned" >> $TEST_OUT
+echo "buffer_size:100000" >> $TEST_OUT
+big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, line_aligned:true, buffer_size:100000"
+echo "one line per block" >> $TEST_OUT
+head --lines=9 /tmp/load_tools_test/big.tsv > /tmp/load_tools_test/nine.tsv
+big_sums "'/tmp/load_tools_test/nine.tsv', num_attributes:3, line_aligned:true, buffer_size:48"
+echo "no last line delimiter" >> $TEST_OUT
+big_sums "'/tmp/load_tools_test/drop/d.tsv', num_attributes:3, line_aligned:true, buffer_size:64"
+iq_error "aio_input('/tmp/load_tools_test/nine.tsv', num_attributes:3, line_aligned:true, buffer_size:40)"
+
+# Collectives: the ragged line ends are agreed on by readers that do not
+# include the coordinator; aio_save agrees on whether one instance holds the
+# single chunk it saves
+echo "Collectives" >> $TEST_OUT
+echo "instances:(1,2,3)" >> $TEST_OUT
+big_sums "paths:('/tmp/load_tools_test/drop/a.tsv','/tmp/load_tools_test/drop/b.tsv','/tmp/load_tools_test/drop/c.tsv'), instances:(1,2,3), num_attributes:3, buffer_size:10000"
+echo "instances:(3)" >> $TEST_OUT
+big_sums "paths:('/tmp/load_tools_test/big.tsv'), instances:(3), num_attributes:3, buffer_size:100000"
+for i in 0 2
+do
+    echo "aio_save instances:$i" >> $TEST_OUT
+    iquery -anq "aio_save(build(<v:int64>[i=0:4:0:5], i), paths:'/tmp/load_tools_test/one-chunk.tsv', instances:$i, format:'tdv')"
+    cat /tmp/load_tools_test/one-chunk.tsv >> $TEST_OUT
+done
+
+# stream_window: the input is loaded in waves of a few blocks per reader
+echo "stream_window" >> $TEST_OUT
+for p in "stream_window:1, buffer_size:100000" "stream_window:3, read_ahead:2, buffer_size:100000" "stream_window:1"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, $p"
+done
+echo "directory" >> $TEST_OUT
+big_sums "paths:'/tmp/load_tools_test/drop', num_attributes:3, stream_window:2, buffer_size:10000"
+echo "skip:'errors'" >> $TEST_OUT
+iquery -otsv -aq "op_count(aio_input('/tmp/load_tools_test/telemetry.tsv', num_attributes:3, skip:'errors', stream_window:1, buffer_size:100))" >> $TEST_OUT
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, stream_window:-1)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, stream_window:2, parallel_read:true)"
+
+# Lines split between blocks are parsed across the block and its supplement;
+# these block sizes cut the 48 byte lines at every point of a line
+echo "Split Lines" >> $TEST_OUT
+for b in 49 50 52 56 64 95 97
+do
+    echo "buffer_size:$b" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/nine.tsv', num_attributes:3, buffer_size:$b"
+done
+echo "short lines, buffer_size:50" >> $TEST_OUT
+iquery -otsv -aq "project(aio_input('/tmp/load_tools_test/telemetry.tsv', num_attributes:3, buffer_size:50), a0, a1, error)" | sort -n >> $TEST_OUT
+
+# parse_threads: blocks are parsed by several threads, each into its own
+# array, and gathered into the result
+echo "parse_threads" >> $TEST_OUT
+for p in "parse_threads:4, buffer_size:100000" "parse_threads:3, stream_window:2, buffer_size:100000" "parse_threads:8"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, $p"
+done
+echo "skip:'errors'" >> $TEST_OUT
+iquery -otsv -aq "op_count(aio_input('/tmp/load_tools_test/telemetry.tsv', num_attributes:3, skip:'errors', parse_threads:2, buffer_size:50))" >> $TEST_OUT
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, parse_threads:0)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, parse_threads:257)"
+
+# Tokenizer: a hundred one-digit fields a line, with other delimiters, put
+# many delimiters in every window; fields of 1 to 400 bytes end at every
+# point of a window
+echo "Tokenizer" >> $TEST_OUT
+awk 'BEGIN { for (n = 1; n <= 1000; n++) for (k = 0; k < 100; k++) printf "%d%s", (n * (k + 1)) % 10, (k < 99 ? "," : ";") }' \
+    > /tmp/load_tools_test/wide.txt
+awk 'BEGIN { for (l = 1; l <= 200; l++) { s = ""; for (i = 0; i < l; i++) s = s "x"; t = s s; gsub(/x/, "y", t); printf "%s\t%d\t%s\n", s, l, t } }' \
+    > /tmp/load_tools_test/long.txt
+for p in "buffer_size:10007" "buffer_size:10007, line_aligned:true"
+do
+    echo "wide, $p" >> $TEST_OUT
+    iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/wide.txt', num_attributes:100, attribute_delimiter:',', line_delimiter:';', $p), u, dcast(a0, int64(null)), v, dcast(a36, int64(null)), w, dcast(a99, int64(null))), count(*), sum(u), sum(v), sum(w), count(error))" >> $TEST_OUT
+    echo "long, $p" >> $TEST_OUT
+    iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/long.txt', num_attributes:3, $p), x, strlen(a0), y, dcast(a1, int64(null)), z, strlen(a2)), count(*), sum(x), sum(y), sum(z), count(error))" >> $TEST_OUT
+done
+
+# skip: every 7th line is short and every other 11th long, over many blocks
+echo "skip" >> $TEST_OUT
+awk 'BEGIN { for (n = 1; n <= 100000; n++) { if (n % 7 == 0) printf "%d\t%d\n", n, n % 10; else if (n % 11 == 0) printf "%d\t%d\t%d\textra%d\n", n, n % 10, 2 * n, n; else printf "%d\t%d\t%d\n", n, n % 10, 2 * n } }' \
+    > /tmp/load_tools_test/mixed.tsv
+for p in "skip:'nothing'" "skip:'errors'" "skip:'non-errors'" "skip:'errors', parse_threads:4"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/mixed.tsv', num_attributes:3, buffer_size:100000, $p"
+done
+
+# types: fields are converted as they are parsed; numbers are read strictly,
+# out of range values do not convert, and long numbers do
+echo "types" >> $TEST_OUT
+iquery -otsv -aq "aggregate(aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, buffer_size:100000, types:('int64','int32','string')), count(*), sum(a0), sum(a1), count(error))" >> $TEST_OUT
+printf '1\t1.5\ttrue\n-128\t-2e3\tFALSE\n127\t.5\t1\n128\t 1\t0\nx\t0x10\tyes\n\tinf\t\n5\tnan\t0\n7\t1e400\t1\n' \
+    > /tmp/load_tools_test/types.tsv
+printf '9\t1.%070d1\t0\n' 0 >> /tmp/load_tools_test/types.tsv
+for p in "" ", parse_threads:2, buffer_size:80"
+do
+    echo "types:('int8','double','bool')$p" >> $TEST_OUT
+    iquery -otsv -aq "aio_input('/tmp/load_tools_test/types.tsv', num_attributes:3, types:('int8','double','bool')$p)" | LC_ALL=C sort >> $TEST_OUT
+done
+iq_error "aio_input('/tmp/load_tools_test/types.tsv', num_attributes:3, types:('int8','double','bool'), split_on_dimension:true)"
+iq_error "aio_input('/tmp/load_tools_test/types.tsv', num_attributes:3, types:('int8','double'))"
+iq_error "aio_input('/tmp/load_tools_test/types.tsv', num_attributes:3, types:('int8','double','date'))"
+
+# target: lines go straight into the cells of the target schema; the last of
+# two lines for a cell wins, and lines that do not fit are dropped
+echo "target" >> $TEST_OUT
+printf '0\t0\t1.5\ta\n1\t2\t2.5\tb\n1\t2\t3.5\tc\n100\t0\t9\td\n\t3\t9\te\n2\t3\toops\tf\n3\t4\t\tg\n5\t5\t7\th\textra\n' \
+    > /tmp/load_tools_test/points.tsv
+POINTS="<val:double null>[x=0:99:0:10; y=0:99:0:10]"
+iquery -otsv -aq "apply(aio_input('/tmp/load_tools_test/points.tsv', target:$POINTS, mapping:('x','y','val','')), xx, x, yy, y)" >> $TEST_OUT
+echo "store" >> $TEST_OUT
+iquery -anq "store(aio_input('/tmp/load_tools_test/big.tsv', buffer_size:100000, parse_threads:2, target:<v:int64 null, s:string null>[i=1:*:0:100000], mapping:('i','v','s')), aio_target_test)"
+iquery -otsv -aq "aggregate(aio_target_test, count(*), sum(v), count(s))" >> $TEST_OUT
+iquery -otsv -aq "between(aio_target_test, 499999, 500000)" >> $TEST_OUT
+iquery -anq "remove(aio_target_test)"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', target:$POINTS)"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', num_attributes:4, mapping:('x','y','val',''))"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', target:$POINTS, mapping:('x','y','val',''), types:('int64','int64','double','string'))"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', num_attributes:3, target:$POINTS, mapping:('x','y','val',''))"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', target:$POINTS, mapping:('x','z','val',''))"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', target:$POINTS, mapping:('x','','val',''))"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', target:<val:double null>[x=0:99:0:*; y=0:99:0:10], mapping:('x','y','val',''))"
+
+# CSV: quoted delimiters, line ends and quotes, CRLF line ends, and records
+# that the blocks cut in the middle
+echo "CSV" >> $TEST_OUT
+printf 'id,name,note\r\n1,plain,simple\r\n2,"with, comma","say ""hi"""\r\n3,"multi\nline",x\r\n4,,""\r\n' \
+    > /tmp/load_tools_test/records.csv
+for p in "" ", buffer_size:32, parse_threads:2"
+do
+    echo "format:'csv'$p" >> $TEST_OUT
+    iquery -otsv -aq "project(apply(aio_input('/tmp/load_tools_test/records.csv', num_attributes:3, format:'csv', header:1$p), n, strlen(a1)), a0, n, a2, error)" \
+        | LC_ALL=C sort >> $TEST_OUT
+done
+# A stray quote, and a record longer than the blocks
+printf '1,"oops,x\n' > /tmp/load_tools_test/stray.csv
+seq 2 50 | sed 's/$/,b,c/' >> /tmp/load_tools_test/stray.csv
+printf '%0200d,b,c\n1,b,c\n' 0 > /tmp/load_tools_test/wide-record.csv
+iq_error "aio_input('/tmp/load_tools_test/stray.csv', num_attributes:3, format:'csv', buffer_size:100)"
+iq_error "aio_input('/tmp/load_tools_test/wide-record.csv', num_attributes:3, format:'csv', buffer_size:100)"
+iq_error "aio_input('/tmp/load_tools_test/records.csv', num_attributes:3, format:'xml')"
+iq_error "aio_input('/tmp/load_tools_test/records.csv', num_attributes:3, format:'csv', attribute_delimiter:'\"')"
+
+# columns: only the columns asked for are loaded, in the order given, but
+# all of them still count for the short and long checks
+echo "columns" >> $TEST_OUT
+echo "columns:(1,0)" >> $TEST_OUT
+big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, buffer_size:100000, columns:(1,0)"
+echo "columns:(2,0), types:('string','int64')" >> $TEST_OUT
+iquery -otsv -aq "aggregate(aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, columns:(2,0), types:('string','int64')), count(*), sum(a0), count(a2), count(error))" >> $TEST_OUT
+echo "columns:(0), short and long lines" >> $TEST_OUT
+iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/mixed.tsv', num_attributes:3, columns:(0)), v, dcast(a0, int64(null))), count(*), sum(v), count(error))" >> $TEST_OUT
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, columns:(0,0))"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, columns:(3))"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, columns:(0,2), types:('int64'))"
+iq_error "aio_input('/tmp/load_tools_test/points.tsv', target:$POINTS, mapping:('x','y','val',''), columns:(0,1,2))"
+
+# where: lines are filtered on their raw fields while they are parsed
+echo "where" >> $TEST_OUT
+for p in "where:('1 eq 3')" "where:('0 between 100,199', '1 in 0,5')" "where:('0 prefix 4999')" "where:('0 between ,10'), parse_threads:2"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, buffer_size:100000, $p"
+done
+echo "columns:(0), where:('1 eq 7')" >> $TEST_OUT
+iquery -otsv -aq "aggregate(apply(aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, columns:(0), where:('1 eq 7')), v, dcast(a0, int64(null))), count(*), sum(v))" >> $TEST_OUT
+echo "short lines" >> $TEST_OUT
+iquery -otsv -aq "op_count(aio_input('/tmp/load_tools_test/telemetry.tsv', num_attributes:3, where:('2 prefix the')))" >> $TEST_OUT
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, where:('5 eq x'))"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, where:('x eq 1'))"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, where:('0 between 1'))"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, where:('0 like 1'))"
+
+# sample: the lines kept depend only on their text, the fraction and the seed,
+# not on how the input is cut into blocks or spread over instances
+echo "sample" >> $TEST_OUT
+for p in "sample:0.1" "sample:0.1, buffer_size:100000" "sample:0.1, buffer_size:100000, line_aligned:true, parse_threads:3" \
+         "sample:0.1, parallel_read:true, buffer_size:100000" "sample:(0.1,42)" "sample:0.01" "sample:1"
+do
+    echo "$p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/big.tsv', num_attributes:3, $p"
+done
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, sample:0)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, sample:1.5)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, sample:(0.5,-1))"
+
+# aio_infer: the statistics gathered on each instance are combined, so they
+# do not depend on how the input is read; a column past the end of every line
+# is all nulls
+echo "aio_infer" >> $TEST_OUT
+for p in "" ", parallel_read:true, buffer_size:100000" ", buffer_size:100000, parse_threads:4" ", max_bytes:1000" ", sample:0.01"
+do
+    echo "big.tsv$p" >> $TEST_OUT
+    iquery -otsv -aq "aio_infer('/tmp/load_tools_test/big.tsv', num_attributes:3$p)" >> $TEST_OUT
+done
+echo "types.tsv" >> $TEST_OUT
+iquery -otsv -aq "aio_infer('/tmp/load_tools_test/types.tsv', num_attributes:4)" >> $TEST_OUT
+echo "mixed.tsv" >> $TEST_OUT
+iquery -otsv -aq "aio_infer('/tmp/load_tools_test/mixed.tsv', num_attributes:4, buffer_size:100000)" >> $TEST_OUT
+iq_error "aio_infer('/tmp/load_tools_test/big.tsv')"
+iq_error "aio_infer('/tmp/load_tools_test/big.tsv', num_attributes:3, max_bytes:0)"
+iq_error "aio_infer('/tmp/load_tools_test/big.tsv', num_attributes:3, max_bytes:1000, parallel_read:true)"
+
+# write_index and use_index: the index records where the data starts, after
+# the header, and is refused once the file changes or for other delimiters or
+# smaller blocks
+echo "write_index" >> $TEST_OUT
+cp /tmp/load_tools_test/big.tsv /tmp/load_tools_test/indexed.tsv
+big_sums "'/tmp/load_tools_test/indexed.tsv', num_attributes:3, buffer_size:100000, header:1, write_index:true"
+for p in "buffer_size:100000" "buffer_size:200000" "buffer_size:100000, parse_threads:2"
+do
+    echo "use_index:true, $p" >> $TEST_OUT
+    big_sums "'/tmp/load_tools_test/indexed.tsv', num_attributes:3, parallel_read:true, use_index:true, $p"
+done
+iq_error "aio_input('/tmp/load_tools_test/indexed.tsv', num_attributes:3, parallel_read:true, use_index:true, buffer_size:50000)"
+iq_error "aio_input('/tmp/load_tools_test/indexed.tsv', num_attributes:3, parallel_read:true, use_index:true, buffer_size:100000, format:'csv')"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, parallel_read:true, use_index:true)"
+touch /tmp/load_tools_test/indexed.tsv
+iq_error "aio_input('/tmp/load_tools_test/indexed.tsv', num_attributes:3, parallel_read:true, use_index:true, buffer_size:100000)"
+big_sums "'/tmp/load_tools_test/indexed.tsv', num_attributes:3, buffer_size:100000, header:1, write_index:true"
+big_sums "'/tmp/load_tools_test/indexed.tsv', num_attributes:3, parallel_read:true, use_index:true, buffer_size:100000"
+printf '500001\t1\tthe quick brown fox jumps over the lazy dog\n' >> /tmp/load_tools_test/indexed.tsv
+iq_error "aio_input('/tmp/load_tools_test/indexed.tsv', num_attributes:3, parallel_read:true, use_index:true, buffer_size:100000)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, use_index:true)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, write_index:true, max_bytes:1000)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv.gz', num_attributes:3, write_index:true)"
+
+# resume: bounded runs each carry on where the last committed one stopped,
+# and together store every line once; the checkpoint is refused if it was
+# left on another number of instances, or a run left its new one behind
+echo "resume" >> $TEST_OUT
+RESUMED="aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, max_bytes:10000000, resume:'/tmp/load_tools_test/ckpt')"
+iquery -anq "store($RESUMED, aio_resume_test)"
+for run in 2 3 4
+do
+    cut --delimiter=' ' --fields=1 < /tmp/load_tools_test/ckpt.0 | tail --lines=1 >> $TEST_OUT
+    iquery -anq "insert($RESUMED, aio_resume_test)"
+done
+cut --delimiter=' ' --fields=1 < /tmp/load_tools_test/ckpt.0 | tail --lines=1 >> $TEST_OUT
+iquery -otsv -aq "op_count($RESUMED)" >> $TEST_OUT
+iquery -otsv -aq "aggregate(apply(aio_resume_test, v, dcast(a0, int64(null)), w, dcast(a1, int64(null))), count(*), sum(v), sum(w), count(error))" >> $TEST_OUT
+iquery -anq "remove(aio_resume_test)"
+sed --in-place '1s/^[0-9]*/1/' /tmp/load_tools_test/ckpt.0
+iq_error "op_count($RESUMED)"
+echo "4 0" > /tmp/load_tools_test/left.0.tmp
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, resume:'/tmp/load_tools_test/left')"
+echo "garbage" > /tmp/load_tools_test/garbage.0
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, resume:'/tmp/load_tools_test/garbage')"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, resume:'/tmp/load_tools_test/nowhere/ckpt')"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv.gz', num_attributes:3, resume:'/tmp/load_tools_test/gz')"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, resume:'')"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, resume:'/tmp/load_tools_test/ckpt', write_index:true)"
+iq_error "aio_input('/tmp/load_tools_test/big.tsv', num_attributes:3, resume:'/tmp/load_tools_test/ckpt', parallel_read:true)"
+
+# Check results
+diff -rub $TEST_OUT $DIR/test-read.expected
+
+# Cleanup
+rm -f $TEST_OUT
+rm -rf /tmp/load_tools_test
@@ -52,6 +52,43 @@ iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header:3, at
 echo "header:3, skip:'non-errors'" >> $TEST_OUT
 iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header:3, attribute_delimiter:' ', num_attributes:3, skip:'non-errors')" >> $TEST_OUT
 
+# Header prefix
+echo "Header Prefix" >> $TEST_OUT
+echo "header_prefix:'%'" >> $TEST_OUT
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header_prefix:'%', attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+echo "header:1, header_prefix:'%'" >> $TEST_OUT
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header:1, header_prefix:'%', attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+echo "header_prefix:'%%'" >> $TEST_OUT
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header_prefix:'%%', attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+echo "header:5" >> $TEST_OUT
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header:5, attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+iquery -aq "aio_input('/tmp/load_tools_test/header-data.ssv', header_prefix:'', attribute_delimiter:' ', num_attributes:3)" 2>&1 | grep "Error description" >> $TEST_OUT || true
+
+# Headers many times longer than the blocks they are read in
+echo "Long Headers" >> $TEST_OUT
+seq 1 300000 > /tmp/load_tools_test/long-header.txt
+echo "header:299998" >> $TEST_OUT
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/long-header.txt', header:299998, num_attributes:1)" >> $TEST_OUT
+seq 1 200000 | sed 's/^/#/' > /tmp/load_tools_test/long-prefix.txt
+echo '1 2 3' >> /tmp/load_tools_test/long-prefix.txt
+echo "header:1, header_prefix:'#'" >> $TEST_OUT
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/long-prefix.txt', header:1, header_prefix:'#', attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+
+# FIFO input: the whole input fits in the first read past the header
+mkfifo /tmp/load_tools_test/header-data.fifo
+echo "FIFO Cases" >> $TEST_OUT
+for h in 2 3 4
+do
+    echo "header:$h" >> $TEST_OUT
+    cat /tmp/load_tools_test/header-data.ssv > /tmp/load_tools_test/header-data.fifo &
+    iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.fifo', header:$h, attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+    wait
+done
+echo "header_prefix:'%'" >> $TEST_OUT
+cat /tmp/load_tools_test/header-data.ssv > /tmp/load_tools_test/header-data.fifo &
+iquery -otsv -aq "aio_input('/tmp/load_tools_test/header-data.fifo', header_prefix:'%', attribute_delimiter:' ', num_attributes:3)" >> $TEST_OUT
+wait
+
 # Check results
 diff -rub $TEST_OUT $DIR/test-skip.expected
 